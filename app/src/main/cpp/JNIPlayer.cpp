@@ -2,6 +2,7 @@
 // Created by Weichuandong on 2025/3/19.
 //
 #include <jni.h>
+#include <android/native_window_jni.h>
 
 #include "Player.h"
 
@@ -56,6 +57,174 @@ Java_com_example_glmediakit_Player_nativeStop(JNIEnv *env, jobject thiz, jlong h
     }
 }
 
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_glmediakit_Player_nativeSeekTo(JNIEnv *env, jobject thiz, jlong handle,
+                                                jdouble position, jboolean accurate) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        player->seekTo(position, accurate ? FFmpegReader::SeekMode::ACCURATE
+                                          : FFmpegReader::SeekMode::KEYFRAME);
+    }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_glmediakit_Player_nativeBeginScrub(JNIEnv *env, jobject thiz, jlong handle) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        player->beginScrub();
+    }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_glmediakit_Player_nativeScrubTo(JNIEnv *env, jobject thiz, jlong handle,
+                                                 jdouble position) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        player->scrubTo(position);
+    }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_glmediakit_Player_nativeEndScrub(JNIEnv *env, jobject thiz, jlong handle) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        player->endScrub();
+    }
+}
+
+extern "C"
+JNIEXPORT jdouble JNICALL
+Java_com_example_glmediakit_Player_nativeGetLastSeekLatencyMs(JNIEnv *env, jobject thiz, jlong handle) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        return player->getLastSeekLatencyMs();
+    }
+    return 0;
+}
+
+extern "C"
+JNIEXPORT jstring JNICALL
+Java_com_example_glmediakit_Player_nativeGetVideoDecoderInfo(JNIEnv *env, jobject thiz, jlong handle) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        return env->NewStringUTF(player->getVideoDecoderInfo().c_str());
+    }
+    return nullptr;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_example_glmediakit_Player_nativeSetPlaybackRate(JNIEnv *env, jobject thiz, jlong handle,
+                                                         jfloat rate) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        return player->setPlaybackRate(rate);
+    }
+    return false;
+}
+
+// 顺序与PlaybackStats.java中的下标一致
+extern "C"
+JNIEXPORT jdoubleArray JNICALL
+Java_com_example_glmediakit_Player_nativeGetStats(JNIEnv *env, jobject thiz, jlong handle) {
+    if (handle == 0) return nullptr;
+    auto* player = reinterpret_cast<Player*>(handle);
+    PlaybackStats::Snapshot stats = player->getStats();
+
+    const jdouble values[] = {
+            (jdouble)stats.videoPacketQueuePackets,
+            (jdouble)stats.videoPacketQueueBytes,
+            (jdouble)stats.audioPacketQueuePackets,
+            (jdouble)stats.audioPacketQueueBytes,
+            (jdouble)stats.videoFrameQueueSize,
+            (jdouble)stats.audioFrameQueueSize,
+            (jdouble)stats.videoFramesDecoded,
+            (jdouble)stats.audioFramesDecoded,
+            (jdouble)stats.videoFramesRendered,
+            (jdouble)stats.videoFramesDropped,
+            (jdouble)stats.bytesRead,
+            stats.lastAvDriftMs,
+            stats.avDrift.p50Ms, stats.avDrift.p90Ms, stats.avDrift.p99Ms, stats.avDrift.maxMs,
+            stats.videoDecodeTime.p50Ms, stats.videoDecodeTime.p90Ms,
+            stats.videoDecodeTime.p99Ms, stats.videoDecodeTime.maxMs,
+            stats.uploadTime.p50Ms, stats.uploadTime.p90Ms, stats.uploadTime.p99Ms, stats.uploadTime.maxMs,
+            (jdouble)stats.videoFramesDroppedLate,
+            (jdouble)stats.videoDecodeLevel,
+    };
+    const jsize count = sizeof(values) / sizeof(values[0]);
+    jdoubleArray array = env->NewDoubleArray(count);
+    if (array) {
+        env->SetDoubleArrayRegion(array, 0, count, values);
+    }
+    return array;
+}
+
+// 顺序与FramePacingReport.java中的下标一致
+extern "C"
+JNIEXPORT jdoubleArray JNICALL
+Java_com_example_glmediakit_Player_nativeGetPacingReport(JNIEnv *env, jobject thiz, jlong handle) {
+    if (handle == 0) return nullptr;
+    auto* player = reinterpret_cast<Player*>(handle);
+    FramePacing::Report report = player->getPacingReport();
+
+    const jdouble values[] = {
+            report.refreshIntervalMs,
+            (jdouble)report.framesPresented,
+            (jdouble)report.lateFrames,
+            (jdouble)report.jankFrames,
+            (jdouble)report.repeatedFrames,
+            (jdouble)report.skippedFrames,
+            (jdouble)report.intervalHistogram[0], (jdouble)report.intervalHistogram[1],
+            (jdouble)report.intervalHistogram[2], (jdouble)report.intervalHistogram[3],
+            (jdouble)report.intervalHistogram[4], (jdouble)report.intervalHistogram[5],
+            report.lateness.p50Ms, report.lateness.p90Ms, report.lateness.p99Ms, report.lateness.maxMs,
+            report.swapTime.p50Ms, report.swapTime.p90Ms, report.swapTime.p99Ms, report.swapTime.maxMs,
+    };
+    const jsize count = sizeof(values) / sizeof(values[0]);
+    jdoubleArray array = env->NewDoubleArray(count);
+    if (array) {
+        env->SetDoubleArrayRegion(array, 0, count, values);
+    }
+    return array;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_example_glmediakit_Player_nativeSetDisplayRefreshRate(JNIEnv *env, jobject thiz, jlong handle,
+                                                               jfloat hz) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        player->setDisplayRefreshRate(hz);
+    }
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_example_glmediakit_Player_nativeStartTrace(JNIEnv *env, jobject thiz, jlong handle) {
+    if (handle != 0) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        return player->startTrace();
+    }
+    return false;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_example_glmediakit_Player_nativeStopTrace(JNIEnv *env, jobject thiz, jlong handle, jstring path) {
+    if (handle != 0 && path) {
+        auto* player = reinterpret_cast<Player*>(handle);
+        const char* filePath = env->GetStringUTFChars(path, nullptr);
+        bool ok = player->stopTrace(filePath);
+        env->ReleaseStringUTFChars(path, filePath);
+        return ok;
+    }
+    return false;
+}
+
 extern "C"
 JNIEXPORT void JNICALL
 Java_com_example_glmediakit_Player_nativeSurfaceCreate(JNIEnv *env, jobject thiz, jlong handle,
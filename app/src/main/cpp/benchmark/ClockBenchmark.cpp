@@ -0,0 +1,113 @@
+//
+// Created by Weichuandong on 2025/4/26.
+//
+// SeqlockClock 压力测试: 两个写线程(模拟音频回调更新和seek时的reset)与两个读线程(模拟渲染线程)同时访问一个时钟，
+// 校验每次读到的pts/lastUpdateTime都是同一次写入的值，并与加锁的实现对比吞吐
+// 用法: ClockBenchmark [每个写线程的写入次数]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "core/SeqlockClock.hpp"
+
+// 对照组: 读写都加锁
+class MutexClock {
+public:
+    void store(const IClock& c) {
+        std::lock_guard<std::mutex> lock(mtx);
+        clock = c;
+    }
+
+    IClock load() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return clock;
+    }
+
+private:
+    mutable std::mutex mtx;
+    IClock clock;
+};
+
+struct BenchResult {
+    double writesPerSec;
+    double readsPerSec;
+    uint64_t maxWriteNs;
+};
+
+// 写入的值满足 lastUpdateTime == pts * 2 + 1，读到不满足的一对说明读到了两次不同写入的数据
+template<typename Clock>
+BenchResult runOnce(uint64_t count) {
+    Clock clock;
+    clock.store(IClock{0.0, 1.0});
+    std::atomic<int> writersDone{0};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> maxWriteNs{0};
+
+    auto writer = [&](double sign) {
+        uint64_t localMax = 0;
+        for (uint64_t i = 1; i <= count; ++i) {
+            IClock c;
+            c.pts = sign * (double)i;
+            c.lastUpdateTime = c.pts * 2 + 1;
+
+            auto begin = std::chrono::steady_clock::now();
+            clock.store(c);
+            uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin).count();
+            if (ns > localMax) localMax = ns;
+        }
+        uint64_t prev = maxWriteNs.load();
+        while (localMax > prev && !maxWriteNs.compare_exchange_weak(prev, localMax)) {
+        }
+        writersDone.fetch_add(1);
+    };
+
+    auto reader = [&]() {
+        uint64_t n = 0;
+        while (writersDone.load(std::memory_order_relaxed) < 2) {
+            IClock c = clock.load();
+            if (c.lastUpdateTime != c.pts * 2 + 1) {
+                fprintf(stderr, "torn read: pts = %f, lastUpdateTime = %f\n", c.pts, c.lastUpdateTime);
+                std::abort();
+            }
+            ++n;
+        }
+        reads.fetch_add(n);
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.emplace_back(writer, 1.0);
+    threads.emplace_back(writer, -1.0);
+    threads.emplace_back(reader);
+    threads.emplace_back(reader);
+    for (auto& t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    return {count * 2 / seconds, reads.load() / seconds, maxWriteNs.load()};
+}
+
+template<typename Clock>
+void report(const char* name, uint64_t count) {
+    runOnce<Clock>(count / 10);
+    BenchResult r = runOnce<Clock>(count);
+    printf("%-12s %12.0f writes/s  %12.0f reads/s  max write %8.1f us\n",
+           name, r.writesPerSec, r.readsPerSec, r.maxWriteNs / 1000.0);
+}
+
+int main(int argc, char** argv) {
+    uint64_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+
+    report<SeqlockClock>("SeqlockClock", count);
+    report<MutexClock>("MutexClock", count);
+    printf("no torn reads\n");
+    return 0;
+}
@@ -0,0 +1,469 @@
+//
+// Created by Weichuandong on 2025/4/21.
+//
+// 解封装 + 解码吞吐测试，不渲染、不输出音频，结果以JSON输出到stdout(日志在stderr)
+// 用法: DecodeBenchmark [--threading policy,live,frame:4] [--frame-buffers pooled|default] [--seconds N] [--repeat N] [--output result.json] [--trace trace.json] <文件或目录>...
+//   --threading 视频解码多线程方式列表，每个片段按每一项各测一次:
+//               policy: DecoderThreading按VOD选择; live: 按低延迟选择; frame:N/slice:N: 指定方式和线程数;
+//               N: 只指定线程数(0为FFmpeg自动)。默认 policy,live,1,frame:2,frame:4,slice:2,slice:4
+//   --threads  只指定线程数的列表，等价于--threading N,N...
+//   --frame-buffers 视频帧缓冲区: pooled为VideoBufferPool(默认)，default为FFmpeg默认分配
+//   --seconds  每个片段最多测试的媒体时长(秒)，默认不限制
+//   --repeat   每个组合重复次数，取解码最快的一次，默认1
+//   --trace    导出Chrome trace JSON(需要以GLMEDIAKIT_TRACE编译)
+// 目录参数会展开为目录下的所有文件(不递归)，按文件名排序
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#include "Demuxer/FFmpegDemuxer.h"
+#include "Decoder/FFmpegVideoDecoder.h"
+#include "Decoder/FFmpegAudioDecoder.h"
+#include "io/FFmpegPacket.hpp"
+#include "io/FFmpegFrame.hpp"
+#include "core/Trace.hpp"
+#include "core/DecoderThreading.hpp"
+
+struct Options {
+    std::vector<std::string> threading{"policy", "live", "1", "frame:2", "frame:4", "slice:2", "slice:4"};
+    std::string frameBuffers{"pooled"};
+    double maxSeconds{0};
+    int repeat{1};
+    std::string output;
+    std::string trace;
+    std::vector<std::string> clips;
+};
+
+struct DemuxResult {
+    int64_t packets{0};
+    int64_t bytes{0};
+    double seconds{0};
+};
+
+struct DecodeResult {
+    int64_t videoPackets{0};
+    int64_t audioPackets{0};
+    int64_t videoFrames{0};
+    int64_t audioFrames{0};
+    double seconds{0};
+    double cpuSeconds{0};
+    long peakRssKB{0};
+    // 第一帧视频输出之前多送入的packet数，即解码器的输出延迟(帧)
+    int64_t firstFrameDelay{-1};
+};
+
+struct ClipInfo {
+    std::string videoCodec;
+    std::string audioCodec;
+    int width{0};
+    int height{0};
+    double duration{0};
+    // DecoderThreading在本机上的选择
+    DecoderThreading::Choice vodChoice;
+    DecoderThreading::Choice liveChoice;
+};
+
+static double nowSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 进程CPU时间，包含解码器内部线程
+static double cpuSeconds() {
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 每次测试前重置峰值RSS(Linux 4.0+支持写入clear_refs)，失败时峰值为进程启动以来的最大值
+static void resetPeakRss() {
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (f) {
+        fputs("5", f);
+        fclose(f);
+    }
+}
+
+static long readPeakRssKB() {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (f) {
+        char line[256];
+        long value = -1;
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                value = strtol(line + 6, nullptr, 10);
+                break;
+            }
+        }
+        fclose(f);
+        if (value >= 0) return value;
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+static void collectClips(const std::string& path, std::vector<std::string>& clips) {
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0) {
+        fprintf(stderr, "skip %s: not found\n", path.c_str());
+        return;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        clips.push_back(path);
+        return;
+    }
+
+    std::vector<std::string> files;
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        std::string file = path + "/" + entry->d_name;
+        if (stat(file.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            files.push_back(file);
+        }
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+    clips.insert(clips.end(), files.begin(), files.end());
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((arg == "--threading" || arg == "--threads") && hasValue) {
+            options.threading.clear();
+            std::string list = argv[++i];
+            size_t pos = 0;
+            while (pos <= list.size()) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                if (comma > pos) options.threading.push_back(list.substr(pos, comma - pos));
+                pos = comma + 1;
+            }
+        } else if (arg == "--frame-buffers" && hasValue) {
+            options.frameBuffers = argv[++i];
+            if (options.frameBuffers != "pooled" && options.frameBuffers != "default") return false;
+        } else if (arg == "--seconds" && hasValue) {
+            options.maxSeconds = atof(argv[++i]);
+        } else if (arg == "--repeat" && hasValue) {
+            options.repeat = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--output" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--trace" && hasValue) {
+            options.trace = argv[++i];
+        } else if (arg.rfind("--", 0) == 0) {
+            return false;
+        } else {
+            collectClips(arg, options.clips);
+        }
+    }
+    return !options.clips.empty() && !options.threading.empty();
+}
+
+// 把--threading的一项转换为解码器参数
+static void applyThreading(const std::string& spec, DecoderConfig& config) {
+    if (spec == "policy") return;
+    if (spec == "live") {
+        config.parameters["latency"] = "live";
+        return;
+    }
+    size_t colon = spec.find(':');
+    if (colon == std::string::npos) {
+        config.parameters["threads"] = spec;
+    } else {
+        config.parameters["thread_type"] = spec.substr(0, colon);
+        config.parameters["threads"] = spec.substr(colon + 1);
+    }
+}
+
+// packet是否超出测试时长
+static bool beyondLimit(const AVPacket* packet, AVRational timeBase, double startTime, double maxSeconds) {
+    if (maxSeconds <= 0 || packet->pts == AV_NOPTS_VALUE) return false;
+    return packet->pts * av_q2d(timeBase) - startTime > maxSeconds;
+}
+
+// 只解封装，不解码
+static bool runDemux(const std::string& clip, const Options& options, DemuxResult& result, ClipInfo& info) {
+    FFmpegDemuxer demuxer;
+    if (!demuxer.open(clip)) return false;
+
+    if (demuxer.hasVideo()) {
+        auto par = demuxer.getVideoCodecParameters();
+        info.videoCodec = avcodec_get_name(par->codec_id);
+        info.width = par->width;
+        info.height = par->height;
+
+        const AVCodec* codec = avcodec_find_decoder(par->codec_id);
+        if (codec) {
+            int cores = (int)std::thread::hardware_concurrency();
+            info.vodChoice = DecoderThreading::choose(
+                    DecoderThreading::describe(codec, par, cores, DecoderThreading::Latency::VOD));
+            info.liveChoice = DecoderThreading::choose(
+                    DecoderThreading::describe(codec, par, cores, DecoderThreading::Latency::LIVE));
+        }
+    }
+    if (demuxer.hasAudio()) {
+        info.audioCodec = avcodec_get_name(demuxer.getAudioCodecParameters()->codec_id);
+    }
+    info.duration = demuxer.getDuration();
+
+    AVPacket* packet = av_packet_alloc();
+    double begin = nowSeconds();
+    while (demuxer.ReceivePacket(packet) >= 0) {
+        int index = packet->stream_index;
+        bool isVideo = index == demuxer.getVideoStreamIndex();
+        AVRational tb = isVideo ? demuxer.getVideoTimeBase() : demuxer.getAudioTimeBase();
+        if ((isVideo || index == demuxer.getAudioStreamIndex()) &&
+            beyondLimit(packet, tb, demuxer.getStartTime(), options.maxSeconds)) {
+            av_packet_unref(packet);
+            break;
+        }
+        result.packets++;
+        result.bytes += packet->size;
+        av_packet_unref(packet);
+    }
+    result.seconds = nowSeconds() - begin;
+    av_packet_free(&packet);
+    return true;
+}
+
+// 解码到取空为止，返回得到的帧数
+static int64_t drainFrames(IDecoder& decoder, std::shared_ptr<IMediaFrame>& mediaFrame, AVFrame* frame) {
+    int64_t frames = 0;
+    while (decoder.ReceiveFrame(mediaFrame) == 0) {
+        frames++;
+        av_frame_unref(frame);
+    }
+    return frames;
+}
+
+// 解封装 + 音视频解码
+static bool runDecode(const std::string& clip, const std::string& threading, const Options& options,
+                      DecodeResult& result) {
+    FFmpegDemuxer demuxer;
+    if (!demuxer.open(clip)) return false;
+
+    std::unique_ptr<FFmpegVideoDecoder> videoDecoder;
+    std::unique_ptr<FFmpegAudioDecoder> audioDecoder;
+    if (demuxer.hasVideo()) {
+        videoDecoder = std::make_unique<FFmpegVideoDecoder>();
+        DecoderConfig config;
+        config.param = demuxer.getVideoCodecParameters();
+        applyThreading(threading, config);
+        config.parameters["frame_buffers"] = options.frameBuffers;
+        if (!videoDecoder->configure(config)) return false;
+    }
+    if (demuxer.hasAudio()) {
+        audioDecoder = std::make_unique<FFmpegAudioDecoder>();
+        DecoderConfig config;
+        config.param = demuxer.getAudioCodecParameters();
+        if (!audioDecoder->configure(config)) return false;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    auto packetWrapper = std::make_shared<FFmpegPacket>();
+    std::shared_ptr<IMediaPacket> mediaPacket = packetWrapper;
+    std::shared_ptr<IMediaFrame> mediaFrame = std::make_shared<FFmpegFrame>(frame);
+
+    resetPeakRss();
+    double cpuBegin = cpuSeconds();
+    double begin = nowSeconds();
+
+    while (demuxer.ReceivePacket(packet) >= 0) {
+        int index = packet->stream_index;
+        IDecoder* decoder = nullptr;
+        AVRational tb{0, 1};
+        int64_t* packets = nullptr;
+        int64_t* frames = nullptr;
+        if (videoDecoder && index == demuxer.getVideoStreamIndex()) {
+            decoder = videoDecoder.get();
+            tb = demuxer.getVideoTimeBase();
+            packets = &result.videoPackets;
+            frames = &result.videoFrames;
+        } else if (audioDecoder && index == demuxer.getAudioStreamIndex()) {
+            decoder = audioDecoder.get();
+            tb = demuxer.getAudioTimeBase();
+            packets = &result.audioPackets;
+            frames = &result.audioFrames;
+        }
+        if (!decoder) {
+            av_packet_unref(packet);
+            continue;
+        }
+        if (beyondLimit(packet, tb, demuxer.getStartTime(), options.maxSeconds)) {
+            av_packet_unref(packet);
+            break;
+        }
+
+        (*packets)++;
+        packetWrapper->rebind(packet);
+        decoder->SendPacket(mediaPacket);
+        *frames += drainFrames(*decoder, mediaFrame, frame);
+        if (frames == &result.videoFrames && *frames > 0 && result.firstFrameDelay < 0) {
+            result.firstFrameDelay = result.videoPackets - 1;
+        }
+        av_packet_unref(packet);
+    }
+
+    // 送入空包取出解码器中缓存的帧
+    packetWrapper->rebind(nullptr);
+    if (videoDecoder) {
+        videoDecoder->SendPacket(mediaPacket);
+        result.videoFrames += drainFrames(*videoDecoder, mediaFrame, frame);
+    }
+    if (audioDecoder) {
+        audioDecoder->SendPacket(mediaPacket);
+        result.audioFrames += drainFrames(*audioDecoder, mediaFrame, frame);
+    }
+
+    result.seconds = nowSeconds() - begin;
+    result.cpuSeconds = cpuSeconds() - cpuBegin;
+    result.peakRssKB = readPeakRssKB();
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--threading policy,live,frame:4,slice:4,1] [--frame-buffers pooled|default] [--seconds N] [--repeat N] [--output file] [--trace file] "
+                        "<clip|dir>...\n",
+                argv[0]);
+        return 1;
+    }
+
+    if (!options.trace.empty()) {
+        if (!GLMEDIAKIT_TRACE_ENABLED) {
+            fprintf(stderr, "--trace ignored: rebuild with -DGLMEDIAKIT_TRACE=ON\n");
+        }
+        TRACE_THREAD_NAME("benchmark");
+        Trace::start();
+    }
+
+    FILE* out = stdout;
+    if (!options.output.empty()) {
+        out = fopen(options.output.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "failed to open %s\n", options.output.c_str());
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n  \"benchmark\": \"DecodeBenchmark\",\n");
+    fprintf(out, "  \"avcodec_version\": \"%u.%u.%u\",\n", LIBAVCODEC_VERSION_MAJOR,
+            LIBAVCODEC_VERSION_MINOR, LIBAVCODEC_VERSION_MICRO);
+    fprintf(out, "  \"hardware_concurrency\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(out, "  \"frame_buffers\": \"%s\",\n", options.frameBuffers.c_str());
+    fprintf(out, "  \"max_seconds\": %.3f,\n  \"repeat\": %d,\n  \"results\": [", options.maxSeconds, options.repeat);
+
+    bool first = true;
+    int failures = 0;
+    for (const std::string& clip : options.clips) {
+        DemuxResult demux;
+        ClipInfo info;
+        if (!runDemux(clip, options, demux, info)) {
+            fprintf(stderr, "failed to open %s\n", clip.c_str());
+            failures++;
+            continue;
+        }
+
+        for (const std::string& threading : options.threading) {
+            DecodeResult best;
+            bool ok = false;
+            for (int i = 0; i < options.repeat; ++i) {
+                DecodeResult r;
+                if (!runDecode(clip, threading, options, r)) break;
+                if (!ok || r.seconds < best.seconds) best = r;
+                ok = true;
+            }
+            if (!ok) {
+                fprintf(stderr, "failed to decode %s with threading %s\n", clip.c_str(), threading.c_str());
+                failures++;
+                continue;
+            }
+
+            int64_t frames = best.videoFrames + best.audioFrames;
+            // 有视频时按视频帧计算单帧CPU时间，纯音频文件按音频帧计算
+            int64_t costFrames = best.videoFrames > 0 ? best.videoFrames : best.audioFrames;
+            fprintf(out, "%s\n    {\n", first ? "" : ",");
+            fprintf(out, "      \"clip\": \"%s\",\n", jsonEscape(clip).c_str());
+            fprintf(out, "      \"video_codec\": \"%s\", \"audio_codec\": \"%s\",\n",
+                    info.videoCodec.c_str(), info.audioCodec.c_str());
+            fprintf(out, "      \"width\": %d, \"height\": %d, \"duration\": %.3f,\n",
+                    info.width, info.height, info.duration);
+            fprintf(out, "      \"threading\": \"%s\",", jsonEscape(threading).c_str());
+            if (threading == "policy" || threading == "live") {
+                const auto& choice = threading == "policy" ? info.vodChoice : info.liveChoice;
+                fprintf(out, " \"threads\": %d, \"thread_type\": \"%s\",",
+                        choice.threadCount, DecoderThreading::typeName(choice.threadType));
+            }
+            fprintf(out, " \"first_frame_delay\": %lld,\n", (long long)best.firstFrameDelay);
+            fprintf(out, "      \"demux\": {\"packets\": %lld, \"bytes\": %lld, \"seconds\": %.6f, "
+                         "\"packets_per_sec\": %.1f},\n",
+                    (long long)demux.packets, (long long)demux.bytes, demux.seconds,
+                    demux.seconds > 0 ? demux.packets / demux.seconds : 0.0);
+            fprintf(out, "      \"decode\": {\"video_packets\": %lld, \"audio_packets\": %lld, "
+                         "\"video_frames\": %lld, \"audio_frames\": %lld, \"seconds\": %.6f,\n",
+                    (long long)best.videoPackets, (long long)best.audioPackets,
+                    (long long)best.videoFrames, (long long)best.audioFrames, best.seconds);
+            fprintf(out, "                 \"frames_per_sec\": %.1f, \"video_frames_per_sec\": %.1f, "
+                         "\"cpu_seconds\": %.6f, \"cpu_ms_per_frame\": %.4f},\n",
+                    best.seconds > 0 ? frames / best.seconds : 0.0,
+                    best.seconds > 0 ? best.videoFrames / best.seconds : 0.0,
+                    best.cpuSeconds,
+                    costFrames > 0 ? best.cpuSeconds * 1000 / costFrames : 0.0);
+            fprintf(out, "      \"peak_rss_kb\": %ld\n    }", best.peakRssKB);
+            fflush(out);
+            first = false;
+        }
+    }
+
+    fprintf(out, "\n  ],\n  \"failures\": %d\n}\n", failures);
+    if (out != stdout) fclose(out);
+
+    if (!options.trace.empty() && GLMEDIAKIT_TRACE_ENABLED) {
+        Trace::stop();
+        if (!Trace::dumpChromeJson(options.trace)) {
+            fprintf(stderr, "failed to write trace to %s\n", options.trace.c_str());
+        }
+    }
+    return failures > 0 ? 2 : 0;
+}
@@ -0,0 +1,208 @@
+//
+// Created by Weichuandong on 2025/5/2.
+//
+// 解码器回退测试: FFmpegReader使用的DecoderFactory第一个候选换成假的硬解码器，按不同方式失败，
+// 检查最终选用的解码器、选择记录，以及输出的前N帧与只用软解时完全一致(回退时没有丢帧)
+// 假硬解码器的失败方式:
+//   ok:        正常解码(内部为FFmpeg软解)，不应回退
+//   probe:     能力表不支持该分辨率，不创建
+//   configure: configure()失败
+//   send:      SendPacket总是失败
+//   silent:    接收packet但一直不出帧
+// 用法: DecoderFallbackBenchmark [--frames N] <文件>
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Reader/FFmpegReader.h"
+#include "Decoder/DecoderFactory.h"
+#include "Decoder/FFmpegVideoDecoder.h"
+
+class FakeHardwareDecoder : public IVideoDecoder {
+public:
+    enum class Mode { OK, SEND_ERROR, SILENT };
+
+    explicit FakeHardwareDecoder(Mode mode) : mode(mode) {}
+
+    int SendPacket(const std::shared_ptr<IMediaPacket>& packet) override {
+        switch (mode) {
+            case Mode::OK:
+                return decoder.SendPacket(packet);
+            case Mode::SEND_ERROR:
+                return -1;
+            case Mode::SILENT:
+                return 0;
+        }
+        return -1;
+    }
+
+    int ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) override {
+        return mode == Mode::OK ? decoder.ReceiveFrame(frame) : AVERROR(EAGAIN);
+    }
+
+    bool isReadying() override { return decoder.isReadying(); }
+    bool configure(const DecoderConfig& config) override { return decoder.configure(config); }
+    void flush() override { decoder.flush(); }
+    int getWidth() override { return decoder.getWidth(); }
+    int getHeight() override { return decoder.getHeight(); }
+    PixFormat getPixFormat() override { return decoder.getPixFormat(); }
+
+private:
+    Mode mode;
+    FFmpegVideoDecoder decoder;
+};
+
+struct Case {
+    const char* name;
+    bool expectHardware;        // 最终应当使用(假)硬解
+};
+
+static std::unique_ptr<DecoderFactory> createFactory(const std::string& mode) {
+    std::vector<DecoderFactory::Candidate> candidates;
+    if (!mode.empty()) {
+        DecoderFactory::Caps caps;
+        std::vector<DecoderFactory::Caps> capsList;
+        // 每种编码格式都支持，probe模式下最大分辨率16x16
+        for (int id = AV_CODEC_ID_NONE + 1; id < AV_CODEC_ID_FIRST_AUDIO; ++id) {
+            caps.codecId = static_cast<AVCodecID>(id);
+            caps.maxWidth = caps.maxHeight = mode == "probe" ? 16 : 0;
+            caps.maxBitDepth = 0;
+            capsList.push_back(caps);
+        }
+        candidates.push_back(DecoderFactory::hardwareCandidate("fake-hw", capsList,
+                [mode](const DecoderConfig& config, bool& needAnnexB) -> std::unique_ptr<IVideoDecoder> {
+                    needAnnexB = false;
+                    if (mode == "configure") return nullptr;
+                    auto fakeMode = mode == "send" ? FakeHardwareDecoder::Mode::SEND_ERROR :
+                                    mode == "silent" ? FakeHardwareDecoder::Mode::SILENT :
+                                    FakeHardwareDecoder::Mode::OK;
+                    auto decoder = std::make_unique<FakeHardwareDecoder>(fakeMode);
+                    if (!decoder->configure(config)) return nullptr;
+                    return decoder;
+                }));
+    }
+
+    DecoderFactory::Candidate software;
+    software.name = "FFmpeg";
+    software.create = [](const DecoderConfig& config, bool& needAnnexB) -> std::unique_ptr<IVideoDecoder> {
+        needAnnexB = false;
+        auto decoder = std::make_unique<FFmpegVideoDecoder>();
+        if (!decoder->configure(config)) return nullptr;
+        return decoder;
+    };
+    candidates.push_back(std::move(software));
+    return std::make_unique<DecoderFactory>(std::move(candidates));
+}
+
+struct RunResult {
+    std::vector<int64_t> pts;
+    double firstFrameMs{-1};
+    DecoderFactory::Selection selection;
+};
+
+// mode为空时只用软解，作为对照
+static bool run(const std::string& clip, const std::string& mode, int frames, RunResult& result) {
+    auto videoFrameQueue = std::make_shared<SPSCQueue<AVFrame*>>(3, 32);
+    auto audioFrameQueue = std::make_shared<SPSCQueue<AVFrame*>>(10, 128);
+    auto videoFramePool = std::make_shared<FramePool>(34);
+    auto audioFramePool = std::make_shared<FramePool>(130);
+    videoFrameQueue->setRecycler([videoFramePool](AVFrame* frame) { videoFramePool->release(frame); });
+    audioFrameQueue->setRecycler([audioFramePool](AVFrame* frame) { audioFramePool->release(frame); });
+
+    FFmpegReader reader(videoFrameQueue, audioFrameQueue, videoFramePool, audioFramePool);
+    reader.setVideoDecoderFactory(createFactory(mode));
+    if (!reader.open(clip) || !reader.hasVideo()) return false;
+
+    auto begin = std::chrono::steady_clock::now();
+    reader.start();
+
+    // 音频帧直接丢弃，避免音频队列满时阻塞解封装
+    std::atomic<bool> done{false};
+    std::thread audioDrain([&]() {
+        AVFrame* frame = nullptr;
+        while (!done) {
+            if (audioFrameQueue->pop(frame, 10)) audioFramePool->release(frame);
+        }
+    });
+
+    int idle = 0;
+    while ((int)result.pts.size() < frames && idle < 300) {
+        AVFrame* frame = nullptr;
+        if (!videoFrameQueue->pop(frame, 10)) {
+            idle++;
+            continue;
+        }
+        idle = 0;
+        if (result.firstFrameMs < 0) {
+            result.firstFrameMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - begin).count();
+        }
+        result.pts.push_back(frame->pts);
+        videoFramePool->release(frame);
+    }
+
+    result.selection = reader.getVideoDecoderSelection();
+    reader.stop();
+    done = true;
+    audioDrain.join();
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int frames = 30;
+    std::string clip;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            frames = std::max(1, atoi(argv[++i]));
+        } else {
+            clip = arg;
+        }
+    }
+    if (clip.empty()) {
+        fprintf(stderr, "usage: %s [--frames N] <clip>\n", argv[0]);
+        return 1;
+    }
+
+    RunResult baseline;
+    if (!run(clip, "", frames, baseline) || baseline.pts.empty()) {
+        fprintf(stderr, "failed to decode %s with FFmpeg\n", clip.c_str());
+        return 1;
+    }
+
+    const Case cases[] = {
+            {"ok",        true},
+            {"probe",     false},
+            {"configure", false},
+            {"send",      false},
+            {"silent",    false},
+    };
+
+    printf("%-10s %-8s %6s %9s %5s  %s\n", "mode", "decoder", "frames", "first(ms)", "same", "selection");
+    printf("%-10s %-8s %6zu %9.1f %5s  %s\n", "baseline", baseline.selection.name.c_str(), baseline.pts.size(),
+           baseline.firstFrameMs, "-", baseline.selection.describe().c_str());
+    bool ok = true;
+    for (const auto& c : cases) {
+        RunResult r;
+        if (!run(clip, c.name, frames, r)) {
+            printf("%-10s failed to open\n", c.name);
+            ok = false;
+            continue;
+        }
+        bool same = r.pts == baseline.pts;
+        bool pass = same && r.selection.hardware == c.expectHardware;
+        printf("%-10s %-8s %6zu %9.1f %5s  %s\n", c.name, r.selection.name.c_str(), r.pts.size(), r.firstFrameMs,
+               same ? "yes" : "no", r.selection.describe().c_str());
+        ok = ok && pass;
+    }
+
+    printf("\n%s\n", ok ? "OK" : "FAILED: unexpected decoder or frames differ from software-only decoding");
+    return ok ? 0 : 1;
+}
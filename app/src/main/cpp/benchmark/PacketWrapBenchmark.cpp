@@ -0,0 +1,89 @@
+//
+// Created by Weichuandong on 2025/4/17.
+//
+// 解码循环中包装packet/frame的开销对比：每个packet都make_shared 与 线程内复用包装对象并rebind
+// 用法: PacketWrapBenchmark [packet个数]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "io/FFmpegPacket.hpp"
+#include "io/FFmpegFrame.hpp"
+
+// 模拟解码器接口：只通过IMediaPacket/IMediaFrame访问数据，与SendPacket/ReceiveFrame的调用方式一致
+class FakeDecoder {
+public:
+    virtual ~FakeDecoder() = default;
+
+    virtual int SendPacket(const std::shared_ptr<IMediaPacket>& packet) {
+        AVPacket* pkt = packet->asAVPacket();
+        checksum += pkt->size + packet->getPts();
+        return 0;
+    }
+
+    virtual int ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) {
+        checksum += frame->asAVFrame() != nullptr;
+        return 0;
+    }
+
+    uint64_t checksum{0};
+};
+
+// 修改前：每次循环两次make_shared
+double runMakeShared(FakeDecoder& decoder, AVPacket* packet, AVFrame* frame, uint64_t count) {
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < count; ++i) {
+        packet->pts = (int64_t)i;
+        std::shared_ptr<IMediaPacket> mediaPacket = std::make_shared<FFmpegPacket>(packet);
+        std::shared_ptr<IMediaFrame> mediaFrame = std::make_shared<FFmpegFrame>(frame);
+        decoder.SendPacket(mediaPacket);
+        decoder.ReceiveFrame(mediaFrame);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+// 修改后：包装对象在循环外创建一次，循环内只rebind
+double runRebind(FakeDecoder& decoder, AVPacket* packet, AVFrame* frame, uint64_t count) {
+    auto begin = std::chrono::steady_clock::now();
+    auto packetWrapper = std::make_shared<FFmpegPacket>();
+    std::shared_ptr<IMediaPacket> mediaPacket = packetWrapper;
+    std::shared_ptr<IMediaFrame> mediaFrame = std::make_shared<FFmpegFrame>(frame);
+    for (uint64_t i = 0; i < count; ++i) {
+        packet->pts = (int64_t)i;
+        packetWrapper->rebind(packet);
+        decoder.SendPacket(mediaPacket);
+        decoder.ReceiveFrame(mediaFrame);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+template<typename Fn>
+void report(const char* name, Fn fn, uint64_t count) {
+    // 不调用av_*函数，packet和frame直接放在栈上，不需要链接FFmpeg
+    AVPacket packet{};
+    AVFrame frame{};
+    packet.size = 4096;
+    FakeDecoder decoder;
+
+    fn(decoder, &packet, &frame, count / 10);    // 预热
+    double best = 0;
+    for (int i = 0; i < 3; ++i) {
+        double seconds = fn(decoder, &packet, &frame, count);
+        if (best == 0 || seconds < best) best = seconds;
+    }
+    printf("%-12s %12.0f packets/s  %8.3f s  (checksum %llu)\n",
+           name, count / best, best, (unsigned long long)decoder.checksum);
+}
+
+int main(int argc, char** argv) {
+    uint64_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000000;
+
+    report("make_shared", runMakeShared, count);
+    report("rebind", runRebind, count);
+    return 0;
+}
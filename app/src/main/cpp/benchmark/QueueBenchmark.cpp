@@ -0,0 +1,95 @@
+//
+// Created by Weichuandong on 2025/4/15.
+//
+// SafeQueue 与 SPSCQueue 的单生产者单消费者吞吐对比
+// 用法: QueueBenchmark [每轮元素个数]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+
+#include "core/SafeQueue.hpp"
+#include "core/SPSCQueue.hpp"
+
+struct BenchResult {
+    double seconds;
+    double opsPerSec;
+    uint64_t sizeQueries;
+};
+
+// 生产者push count个元素，消费者全部pop出来并校验顺序；
+// 同时第三个线程不断调用getSize()，模拟读线程日志和渲染线程的丢帧判断
+template<typename Queue>
+BenchResult runOnce(size_t capacity, uint64_t count) {
+    Queue queue(capacity);
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> sizeQueries{0};
+
+    auto begin = std::chrono::steady_clock::now();
+
+    std::thread producer([&]() {
+        for (uint64_t i = 1; i <= count; ++i) {
+            queue.push(i);
+        }
+    });
+
+    std::thread observer([&]() {
+        uint64_t n = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            volatile int size = queue.getSize();
+            (void)size;
+            ++n;
+            std::this_thread::yield();
+        }
+        sizeQueries = n;
+    });
+
+    uint64_t expected = 1;
+    uint64_t item = 0;
+    while (expected <= count) {
+        if (queue.pop(item)) {
+            if (item != expected) {
+                fprintf(stderr, "order broken: expect %llu, got %llu\n",
+                        (unsigned long long)expected, (unsigned long long)item);
+                std::abort();
+            }
+            ++expected;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    done = true;
+    producer.join();
+    observer.join();
+
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    return {seconds, count / seconds, sizeQueries.load()};
+}
+
+template<typename Queue>
+void report(const char* name, size_t capacity, uint64_t count) {
+    // 先跑一轮预热，取后三轮的最好成绩
+    runOnce<Queue>(capacity, count / 10);
+    BenchResult best{0, 0, 0};
+    for (int i = 0; i < 3; ++i) {
+        BenchResult r = runOnce<Queue>(capacity, count);
+        if (r.opsPerSec > best.opsPerSec) best = r;
+    }
+    printf("%-10s capacity=%-4zu %10.0f ops/s  %8.3f s  getSize()=%llu\n",
+           name, capacity, best.opsPerSec, best.seconds,
+           (unsigned long long)best.sizeQueries);
+}
+
+int main(int argc, char** argv) {
+    uint64_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+
+    // 3和10是Player中视频帧队列和音频帧队列的容量
+    for (size_t capacity : {3, 10, 64}) {
+        report<SafeQueue<uint64_t>>("SafeQueue", capacity, count);
+        report<SPSCQueue<uint64_t>>("SPSCQueue", capacity, count);
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+//
+// Created by Weichuandong on 2025/4/29.
+//
+// PresentationScheduler 测试:
+// 1. 假时钟 + 合成帧序列: 模拟渲染循环(调度 -> 等待 -> 绘制 -> 在下一个vsync显示)，
+//    检查每一帧都出现在调度给出的vsync上、与目标时刻的误差不超过半个刷新周期，并输出显示间隔的分布
+// 2. 真实时钟: 比较waitUntil()与直接sleep_for()的唤醒误差
+// 用法: SchedulerBenchmark [真实时钟的等待次数]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "core/PresentationScheduler.hpp"
+
+// 每次系统睡眠多睡OVERSLEEP_US，让出CPU耗时YIELD_US，模拟真实调度的误差
+class FakeTimeSource : public PresentationScheduler::TimeSource {
+public:
+    static constexpr int64_t OVERSLEEP_US = 400;
+    static constexpr int64_t YIELD_US = 20;
+
+    int64_t now() override { return current; }
+
+    void sleepFor(int64_t us) override {
+        current += us <= 0 ? YIELD_US : us + OVERSLEEP_US;
+    }
+
+    void advance(int64_t us) { current += us; }
+
+private:
+    int64_t current = 1000000;
+};
+
+struct Scenario {
+    double fps;
+    double refreshHz;
+    double rate;
+};
+
+struct ScenarioResult {
+    int presented = 0;
+    int dropped = 0;
+    int offTarget = 0;          // 实际显示的vsync与调度结果不一致
+    double maxErrorMs = 0;      // |显示时刻 - 目标时刻|
+    double maxWakeErrorUs = 0;
+    std::map<int64_t, int> intervals;   // 相邻两帧显示间隔(刷新周期数) -> 帧数
+};
+
+static ScenarioResult runScenario(const Scenario& s, int frameCount) {
+    static constexpr int64_t DRAW_US = 3000;
+
+    auto clock = std::make_shared<FakeTimeSource>();
+    PresentationScheduler scheduler(clock);
+    scheduler.setRefreshRate(s.refreshHz);
+    const int64_t refreshUs = scheduler.getRefreshIntervalUs();
+    const int64_t vsyncPhase = clock->now() + 1234;
+    scheduler.onVsync(vsyncPhase);
+
+    // 主时钟从startUs开始以播放速度走动，第一帧也需要等待
+    const int64_t startUs = clock->now() + 50000;
+    auto masterAt = [&](int64_t t) { return (double)(t - startUs) / 1000000 * s.rate; };
+    // swap之后的第一个vsync显示
+    auto nextVsync = [&](int64_t t) {
+        int64_t n = (t - vsyncPhase + refreshUs - 1) / refreshUs;
+        return vsyncPhase + n * refreshUs;
+    };
+
+    ScenarioResult r;
+    int64_t lastDisplayUs = -1;
+    for (int i = 0; i < frameCount; ++i) {
+        const double pts = i / s.fps;
+        const double nextPts = i + 1 < frameCount ? (i + 1) / s.fps : NAN;
+
+        const int64_t syncUs = clock->now();
+        auto d = scheduler.schedule(pts, nextPts, masterAt(syncUs), syncUs, s.rate);
+        if (d.action == PresentationScheduler::Action::DROP) {
+            r.dropped++;
+            continue;
+        }
+
+        scheduler.waitUntil(d.deadlineUs, []() { return false; });
+        r.maxWakeErrorUs = std::max(r.maxWakeErrorUs, (double)(clock->now() - d.deadlineUs));
+        clock->advance(DRAW_US);
+
+        const int64_t displayUs = nextVsync(clock->now());
+        r.presented++;
+        if (displayUs != d.vsyncUs) r.offTarget++;
+        r.maxErrorMs = std::max(r.maxErrorMs, std::fabs((double)(displayUs - d.targetUs)) / 1000);
+        if (lastDisplayUs >= 0) {
+            r.intervals[std::llround((double)(displayUs - lastDisplayUs) / refreshUs)]++;
+        }
+        lastDisplayUs = displayUs;
+    }
+    return r;
+}
+
+static bool runSimulated() {
+    const Scenario scenarios[] = {
+            {24, 60, 1.0},
+            {30, 60, 1.0},
+            {50, 60, 1.0},
+            {60, 60, 1.0},
+            {60, 30, 1.0},
+            {30, 60, 2.0},
+            {60, 60, 2.0},
+            {30, 60, 0.5},
+            {25, 90, 1.0},
+    };
+    const int frameCount = 600;
+    bool ok = true;
+
+    printf("simulated vsync (fake clock, oversleep %lldus, draw 3ms), %d frames each\n",
+           (long long)FakeTimeSource::OVERSLEEP_US, frameCount);
+    printf("%6s %6s %5s | %9s %7s %9s %11s %12s | %s\n",
+           "fps", "hz", "rate", "presented", "dropped", "offTarget", "maxErr(ms)", "maxWake(us)",
+           "display intervals (vsyncs:frames)");
+    for (const auto& s : scenarios) {
+        ScenarioResult r = runScenario(s, frameCount);
+        printf("%6.1f %6.1f %5.2f | %9d %7d %9d %11.2f %12.0f |",
+               s.fps, s.refreshHz, s.rate, r.presented, r.dropped, r.offTarget, r.maxErrorMs, r.maxWakeErrorUs);
+        for (const auto& kv : r.intervals) {
+            printf(" %lld:%d", (long long)kv.first, kv.second);
+        }
+        printf("\n");
+
+        // 每一帧都在调度的vsync上显示，误差不超过半个刷新周期，两帧不共用一个vsync
+        const double halfRefreshMs = 500.0 / s.refreshHz;
+        if (r.offTarget != 0 || r.maxErrorMs > halfRefreshMs + 0.01 || r.intervals.count(0)) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static void printErrors(const char* name, std::vector<int64_t>& errors) {
+    std::sort(errors.begin(), errors.end());
+    auto at = [&](double q) { return errors[std::min(errors.size() - 1, (size_t)(q * errors.size()))]; };
+    printf("%-12s p50 %6lldus  p99 %6lldus  max %6lldus\n", name,
+           (long long)at(0.5), (long long)at(0.99), (long long)errors.back());
+}
+
+static void runRealClock(int count) {
+    PresentationScheduler::SystemTimeSource clock;
+    PresentationScheduler scheduler;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int64_t> delay(2000, 20000);
+
+    std::vector<int64_t> sleepErrors, waitErrors;
+    for (int i = 0; i < count; ++i) {
+        int64_t deadline = clock.now() + delay(rng);
+        std::this_thread::sleep_for(std::chrono::microseconds(deadline - clock.now()));
+        sleepErrors.push_back(clock.now() - deadline);
+
+        deadline = clock.now() + delay(rng);
+        scheduler.waitUntil(deadline, []() { return false; });
+        waitErrors.push_back(clock.now() - deadline);
+    }
+
+    printf("\nreal clock wake-up error, %d waits of 2~20ms\n", count);
+    printErrors("sleep_for", sleepErrors);
+    printErrors("waitUntil", waitErrors);
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 200;
+
+    bool ok = runSimulated();
+    runRealClock(count);
+
+    printf("\n%s\n", ok ? "OK" : "FAILED: frames presented off their scheduled vsync");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#ifndef GLMEDIAKIT_AUDIOFRAMECONVERTER_H
+#define GLMEDIAKIT_AUDIOFRAMECONVERTER_H
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/time.h>
+#include <libswresample/swresample.h>
+};
+
+#include <memory>
+#include <atomic>
+#include <cmath>
+
+#include "core/SPSCQueue.hpp"
+#include "core/FramePool.hpp"
+#include "core/IClock.h"
+#include "core/MediaSynchronizer.hpp"
+#include "platform/FFmpegCompat.h"
+#include "AudioTimeStretcher.h"
+
+/**
+ * 音频输出的公共部分：从帧队列取帧、重采样为16位交织PCM、变速、应用音量、更新音频时钟
+ *
+ * 各平台的音频输出(OpenSL ES回调、桌面的拉取线程)只负责把fill()得到的数据交给设备，
+ * fill()只能在同一个线程中调用。
+ *
+ * 音频时钟按实际播放位置计算: 已送入重采样器的数据末尾的pts，减去重采样器延迟、
+ * 重采样缓冲区和变速器中还没有输出的数据，得到这次输出数据末尾的pts；
+ * 再减去设备中排在前面的数据和这次数据本身的播放时长，就是此刻正在播放的位置。
+ * */
+class AudioFrameConverter {
+public:
+    AudioFrameConverter(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                        std::shared_ptr<FramePool> framePool,
+                        std::shared_ptr<MediaSynchronizer> sync);
+    ~AudioFrameConverter();
+
+    AudioFrameConverter(const AudioFrameConverter&) = delete;
+    AudioFrameConverter& operator=(const AudioFrameConverter&) = delete;
+
+    // 创建重采样上下文，输出格式固定为AV_SAMPLE_FMT_S16
+    bool prepare(int inSampleRate, int inChannels, AVSampleFormat inFormat,
+                 int outSampleRate, int outChannels);
+    void release();
+    bool isPrepared() const { return swrContext != nullptr; }
+
+    // 填充最多size字节的PCM，返回实际填充的字节数；队列为空时最多等待timeoutMs(-1表示一直等待)
+    // queuedLatency为设备中已提交、排在这次数据之前还没有播放的时长(秒)，由输出设备上报
+    int fill(uint8_t* buffer, int size, double queuedLatency, int timeoutMs = -1);
+
+    void setTimeBase(const AVRational& timeBase) { audioTimeBase = timeBase; }
+    void setVolume(float vol) { volume = vol; }
+    // 可以在任意线程调用，下一次fill()时生效
+    void setPlaybackRate(float rate) { playbackRate = rate; }
+    float getVolume() const { return volume.load(); }
+
+    // 丢弃已重采样但还未输出的数据
+    void resetResampleBuffer() { availableSamples = 0; }
+
+    int getOutSampleRate() const { return outSampleRate; }
+    int getOutChannels() const { return outChannels; }
+    int getBytesPerFrame() const { return outChannels * 2; }
+
+private:
+    std::shared_ptr<SPSCQueue<AVFrame*>> audioFrameQueue;
+    std::shared_ptr<FramePool> audioFramePool;
+    std::shared_ptr<MediaSynchronizer> synchronizer;
+    std::atomic<float> volume{1.0f};
+    std::atomic<float> playbackRate{1.0f};
+
+    int outSampleRate = 44100;
+    int outChannels = 2;
+
+    // 重采样
+    SwrContext* swrContext = nullptr;
+    uint8_t* resampleBuffer = nullptr;
+    int resampleBufferSize = 0;
+    int availableSamples = 0;
+
+    // 变速，非1倍速时重采样后的数据先经过时间伸缩
+    AudioTimeStretcher stretcher;
+    float stretchRate = 1.0f;
+
+    // 音频时钟
+    IClock audioClock;
+    AVRational audioTimeBase = {0, 0};
+    // 已送入重采样器的数据末尾的pts(秒)，NAN表示未知
+    double inputEndPts = NAN;
+    // 当前输出数据的seek序号
+    int playSerial = 0;
+
+    // 从解码帧中提取音频并重采样
+    int resampleAudio(AVFrame* frame, uint8_t* outBuffer, int outSize);
+    // 整帧重采样到resampleBuffer，返回样本数
+    int resampleToBuffer(AVFrame* frame);
+    // 非1倍速时的fill()
+    int fillStretched(uint8_t* buffer, int size, int timeoutMs);
+    // 取出一帧，丢弃seek之前的旧帧；没有可用的帧时返回nullptr
+    AVFrame* popFrame(int timeoutMs);
+    void trackInputPts(const AVFrame* frame);
+    // 按这次输出的数据量和设备延迟更新音频时钟
+    void updateClock(int bytesFilled, double queuedLatency);
+
+    // 应用音量
+    void applyVolume(int16_t* buffer, int numSamples);
+};
+
+#endif //GLMEDIAKIT_AUDIOFRAMECONVERTER_H
@@ -0,0 +1,74 @@
+//
+// Created by Weichuandong on 2025/4/28.
+//
+
+#ifndef GLMEDIAKIT_AUDIOTIMESTRETCHER_H
+#define GLMEDIAKIT_AUDIOTIMESTRETCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 不改变音调的音频变速(WSOLA)，输入输出都是16位交织PCM
+ *
+ * 输出按固定步长(hop，20ms)拼接40ms的汉宁窗片段，相邻片段重叠一半；
+ * 输入上每一步前进hop * rate，并在名义位置附近±12ms内搜索与上一片段自然延续最相似的起点，
+ * 避免拼接处波形不连续。rate > 1时加速，rate < 1时减速，音调不变。
+ *
+ * 只能在一个线程中使用(音频输出线程)。
+ * */
+class AudioTimeStretcher {
+public:
+    void prepare(int sampleRate, int channels);
+
+    // 取值0.25~4.0，可以在处理过程中修改
+    void setRate(double rate) { stretchRate = rate; }
+    double getRate() const { return stretchRate; }
+
+    void putSamples(const int16_t* data, int frames);
+    // 取出最多maxFrames帧，返回实际帧数
+    int receiveSamples(int16_t* out, int maxFrames);
+    int getAvailableFrames() const { return (int)(output.size() - outputRead) / channels; }
+    // 已经输入但还没有被receiveSamples()取走的数据，换算为输入帧数
+    double getPendingInputFrames() const;
+
+    // 恢复正常速度时调用: 还没有伸缩的输入原样接在已输出数据之后，保证波形连续
+    void flush();
+    // seek后丢弃所有数据
+    void clear();
+
+private:
+    int channels = 2;
+    int hop = 0;            // 输出步长，也是重叠长度(帧)
+    int segment = 0;        // 片段长度 = 2 * hop
+    int seekWindow = 0;     // 搜索范围(帧)
+    double stretchRate = 1.0;
+
+    std::vector<float> window;
+
+    // 输入，input[0]对应的绝对帧号为inputStart
+    std::vector<float> input;
+    int64_t inputStart = 0;
+    // 下一片段在输入上的名义起点(绝对帧号)
+    double analysisPos = 0;
+    // 上一片段实际选中的起点，-1表示还没有输出过
+    int64_t prevSegment = -1;
+    // 上一片段后半部分加窗后的数据，等待与下一片段叠加
+    std::vector<float> overlap;
+
+    std::vector<int16_t> output;
+    size_t outputRead = 0;
+
+    // 互相关计算用的单声道数据
+    std::vector<float> monoTarget;
+    std::vector<float> monoSearch;
+
+    int64_t inputEnd() const { return inputStart + (int64_t)input.size() / channels; }
+    void process();
+    int64_t findBestSegment(int64_t searchBegin, int64_t searchEnd);
+    void appendOutput(float value);
+    void discardInput(int64_t before);
+};
+
+#endif //GLMEDIAKIT_AUDIOTIMESTRETCHER_H
@@ -0,0 +1,245 @@
+//
+// Created by Weichuandong on 2025/5/2.
+//
+
+#ifndef GLMEDIAKIT_DECODERFACTORY_H
+#define GLMEDIAKIT_DECODERFACTORY_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "interface/IDecoder.h"
+#include "platform/FFmpegCompat.h"
+
+extern "C" {
+#include "libavutil/pixdesc.h"
+}
+
+/**
+ * 视频解码器工厂: 按候选顺序(平台硬解 -> FFmpeg软解)选出第一个可用的解码器
+ *
+ * 每个候选先由probe()按编码格式、profile、level、分辨率和位深判断码流是否在能力范围内，
+ * 通过后再创建并configure()，任意一步失败都记录原因并尝试下一个候选。
+ * configure()成功的硬解仍然可能在开始解码后报错或一直不出帧，这由解码线程用StartupMonitor判断，
+ * 之后调用fallback()换成下一个候选，并把第一帧之前送入的packet重新送给新的解码器。
+ * 每个候选的结果和原因记录在Selection中，用于日志和上层查询。
+ *
+ * 候选列表由调用方给出，桌面环境可以用假的硬解码器验证回退流程(见benchmark/DecoderFallbackBenchmark.cpp)。
+ * create()/fallback()只在打开文件的线程或视频解码线程调用，getSelection()可以在任意线程调用。
+ * */
+class DecoderFactory {
+public:
+    // 硬件解码器对一种编码格式的支持范围，为0或空表示不限制
+    struct Caps {
+        AVCodecID codecId{AV_CODEC_ID_NONE};
+        std::vector<int> profiles;
+        int maxLevel{0};
+        // 按长边/短边比较，竖屏视频同样适用
+        int maxWidth{0};
+        int maxHeight{0};
+        int maxBitDepth{8};
+    };
+
+    struct Candidate {
+        std::string name;
+        bool hardware{false};
+        // 码流不在能力范围内时返回false并给出原因，为空表示不检查
+        std::function<bool(const AVCodecParameters* par, std::string& reason)> probe;
+        // 创建并配置，失败返回nullptr。needAnnexB: 解码器要求Annex-B格式的输入
+        std::function<std::unique_ptr<IVideoDecoder>(const DecoderConfig& config, bool& needAnnexB)> create;
+    };
+
+    struct Attempt {
+        std::string name;
+        std::string result;     // "ok"或失败原因
+    };
+
+    struct Selection {
+        std::string name;       // 当前使用的解码器，全部失败时为空
+        bool hardware{false};
+        bool needAnnexB{false};
+        std::vector<Attempt> attempts;
+
+        // 例如 "MediaCodec(profile 110 not supported) -> FFmpeg(ok)"
+        std::string describe() const {
+            std::string text;
+            for (const auto& attempt : attempts) {
+                if (!text.empty()) text += " -> ";
+                text += attempt.name + "(" + attempt.result + ")";
+            }
+            return text.empty() ? "none" : text;
+        }
+    };
+
+    /**
+     * 解码开始阶段的失败检测: 第一帧输出之前SendPacket失败MAX_SEND_ERRORS次，
+     * 或者送入MAX_PACKETS_WITHOUT_FRAME个packet仍然没有输出。输出过一帧之后不再监视
+     * */
+    class StartupMonitor {
+    public:
+        static constexpr int MAX_SEND_ERRORS = 3;
+        // 帧级多线程(最多8线程)和B帧重排序带来的输出延迟都远小于该值
+        static constexpr int MAX_PACKETS_WITHOUT_FRAME = 60;
+
+        void reset() {
+            watching = true;
+            packets = 0;
+            errors = 0;
+        }
+
+        bool isWatching() const { return watching; }
+
+        void onPacketSent(int ret) {
+            if (!watching) return;
+            packets++;
+            if (ret != 0) errors++;
+        }
+
+        void onFrame() { watching = false; }
+
+        // 没有更多候选时不再监视，继续使用当前解码器
+        void stop() { watching = false; }
+
+        bool failed(std::string& reason) const {
+            if (!watching) return false;
+            if (errors >= MAX_SEND_ERRORS) {
+                reason = std::to_string(errors) + " send errors before first frame";
+                return true;
+            }
+            if (packets >= MAX_PACKETS_WITHOUT_FRAME) {
+                reason = "no frame after " + std::to_string(packets) + " packets";
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        bool watching{true};
+        int packets{0};
+        int errors{0};
+    };
+
+    explicit DecoderFactory(std::vector<Candidate> candidates) :
+        candidates(std::move(candidates))
+    {
+
+    }
+
+    // 平台硬解(getHardwareVideoDecoderCaps()范围内) -> FFmpeg软解
+    static std::unique_ptr<DecoderFactory> createDefault();
+
+    // 用Caps表判断码流的候选，create通常为平台的硬解创建函数
+    static Candidate hardwareCandidate(std::string name, std::vector<Caps> capsList,
+                                       std::function<std::unique_ptr<IVideoDecoder>(const DecoderConfig&, bool&)> create) {
+        Candidate candidate;
+        candidate.name = std::move(name);
+        candidate.hardware = true;
+        candidate.create = std::move(create);
+        candidate.probe = [capsList = std::move(capsList)](const AVCodecParameters* par, std::string& reason) {
+            for (const auto& caps : capsList) {
+                if (caps.codecId == par->codec_id) return checkCaps(caps, par, reason);
+            }
+            reason = std::string("codec ") + avcodec_get_name(par->codec_id) + " not supported";
+            return false;
+        };
+        return candidate;
+    }
+
+    // 码流的profile/level未知(FF_PROFILE_UNKNOWN/FF_LEVEL_UNKNOWN)时不作为排除条件
+    static bool checkCaps(const Caps& caps, const AVCodecParameters* par, std::string& reason) {
+        if (!caps.profiles.empty() && par->profile != FF_PROFILE_UNKNOWN &&
+            std::find(caps.profiles.begin(), caps.profiles.end(), par->profile) == caps.profiles.end()) {
+            reason = "profile " + std::to_string(par->profile) + " not supported";
+            return false;
+        }
+        if (caps.maxLevel > 0 && par->level != FF_LEVEL_UNKNOWN && par->level > caps.maxLevel) {
+            reason = "level " + std::to_string(par->level) + " > " + std::to_string(caps.maxLevel);
+            return false;
+        }
+        if (caps.maxWidth > 0 && caps.maxHeight > 0) {
+            const int longSide = std::max(par->width, par->height);
+            const int shortSide = std::min(par->width, par->height);
+            if (longSide > std::max(caps.maxWidth, caps.maxHeight) ||
+                shortSide > std::min(caps.maxWidth, caps.maxHeight)) {
+                reason = "resolution " + std::to_string(par->width) + "x" + std::to_string(par->height) +
+                         " > " + std::to_string(caps.maxWidth) + "x" + std::to_string(caps.maxHeight);
+                return false;
+            }
+        }
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(par->format));
+        if (caps.maxBitDepth > 0 && desc && desc->comp[0].depth > caps.maxBitDepth) {
+            reason = std::to_string(desc->comp[0].depth) + "-bit not supported";
+            return false;
+        }
+        return true;
+    }
+
+    // 从第一个候选开始选择
+    std::unique_ptr<IVideoDecoder> create(const DecoderConfig& config) {
+        std::lock_guard<std::mutex> lock(mtx);
+        selection = Selection();
+        next = 0;
+        return createFromNext(config);
+    }
+
+    // 当前解码器开始解码后失败，换用后面的候选。没有可用的候选时返回nullptr
+    std::unique_ptr<IVideoDecoder> fallback(const DecoderConfig& config, const std::string& reason) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!selection.attempts.empty()) {
+            selection.attempts.back().result = reason;
+        }
+        selection.name.clear();
+        selection.hardware = false;
+        selection.needAnnexB = false;
+        return createFromNext(config);
+    }
+
+    bool hasFallback() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return next < candidates.size();
+    }
+
+    Selection getSelection() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return selection;
+    }
+
+private:
+    std::vector<Candidate> candidates;
+    mutable std::mutex mtx;
+    Selection selection;
+    size_t next{0};
+
+    std::unique_ptr<IVideoDecoder> createFromNext(const DecoderConfig& config) {
+        while (next < candidates.size()) {
+            const Candidate& candidate = candidates[next++];
+            Attempt attempt{candidate.name, "ok"};
+            std::string reason;
+            if (candidate.probe && !candidate.probe(config.param, reason)) {
+                attempt.result = reason;
+                selection.attempts.push_back(attempt);
+                continue;
+            }
+
+            bool needAnnexB = false;
+            auto decoder = candidate.create(config, needAnnexB);
+            if (!decoder) {
+                attempt.result = "configure failed";
+                selection.attempts.push_back(attempt);
+                continue;
+            }
+            selection.attempts.push_back(attempt);
+            selection.name = candidate.name;
+            selection.hardware = candidate.hardware;
+            selection.needAnnexB = needAnnexB;
+            return decoder;
+        }
+        return nullptr;
+    }
+};
+
+#endif //GLMEDIAKIT_DECODERFACTORY_H
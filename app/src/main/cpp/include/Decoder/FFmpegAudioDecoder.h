@@ -5,7 +5,7 @@
 #ifndef GLMEDIAKIT_FFMPEGAUDIODECODER_H
 #define GLMEDIAKIT_FFMPEGAUDIODECODER_H
 
-#include <android/log.h>
+#include "platform/Log.h"
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -15,9 +15,7 @@
 #include "interface/IDecoder.h"
 #include "core/SafeQueue.hpp"
 #include "core/PerformceTimer.hpp"
-
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "FFmpegAudioDecoder", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "FFmpegAudioDecoder", __VA_ARGS__)
+#include "platform/FFmpegCompat.h"
 
 class FFmpegAudioDecoder : public IAudioDecoder{
 public:
@@ -31,6 +29,8 @@ public:
 
     int ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) override;
 
+    void flush() override;
+
     bool isReadying() override { return isReady; }
 
     int getSampleRate() override { return inSampleRate; }
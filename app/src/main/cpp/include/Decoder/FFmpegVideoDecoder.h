@@ -5,7 +5,7 @@
 #ifndef GLMEDIAKIT_FFMPEGVIDEODECODER_H
 #define GLMEDIAKIT_FFMPEGVIDEODECODER_H
 
-#include <android/log.h>
+#include "platform/Log.h"
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -15,9 +15,8 @@
 #include "interface/IDecoder.h"
 #include "core/SafeQueue.hpp"
 #include "core/PerformceTimer.hpp"
-
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "FFmpegVideoDecoder", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "FFmpegVideoDecoder", __VA_ARGS__)
+#include "core/VideoBufferPool.hpp"
+#include "core/DecodeQualityController.hpp"
 
 class FFmpegVideoDecoder : public IVideoDecoder {
 public:
@@ -31,6 +30,8 @@ public:
 
     int ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) override;
 
+    void flush() override;
+
     bool isReadying() override { return isReady; }
 
     int getWidth() override { return mWidth; }
@@ -39,8 +40,19 @@ public:
 
     PixFormat getPixFormat() override;
 
+    void setFrameDiscard(AVDiscard discard) override;
+
+    void setFrameInterval(double seconds) override;
+
+    // 当前的降质级别，可以在任意线程调用
+    int getQualityLevel() override { return static_cast<int>(quality.getLevel()); }
+
 private:
     AVCodecContext* avCodecContext{nullptr};
+    const AVCodec* codec{nullptr};
+    DecoderConfig config;
+    // 解码输出的帧缓冲区，需要比avCodecContext晚释放
+    std::unique_ptr<VideoBufferPool> bufferPool;
 
     // 状态
     std::atomic<bool> isReady{false};
@@ -50,6 +62,17 @@ private:
     int mHeight;
     AVPixelFormat format;
 
+    // 解码耗时超过帧间隔时逐级降质，只在解码线程调整
+    DecodeQualityController quality;
+    std::atomic<int64_t> frameIntervalUs{0};
+    AVDiscard externalDiscard{AVDISCARD_DEFAULT};
+    int64_t packetDecodeUs{0};
+    bool packetPending{false};
+
+    // 按config创建并打开一个新的解码器上下文，失败返回nullptr
+    AVCodecContext* openContext(int lowres);
+    int wantedLowres() const;
+    void applyQuality();
     void release();
 };
 
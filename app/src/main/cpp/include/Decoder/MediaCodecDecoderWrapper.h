@@ -7,15 +7,11 @@
 
 #include <jni.h>
 #include <string>
-#include <android/log.h>
+#include "platform/Log.h"
 #include <vector>
 
 #include "JNIHelper.h"
 
-#define LOG_TAG "MediaCodecDecoderWrapper"
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-
 class MediaCodecDecoderWrapper {
 public:
     MediaCodecDecoderWrapper();
@@ -30,6 +26,9 @@ public:
     bool getDecodedData(std::vector<uint8_t>& outBuffer, size_t& outSize, int64_t& outPts, int& bufferId);
 
     bool releaseOutputBuffer(int outputBufferId);
+
+    // 丢弃所有输入输出缓冲区中的数据，用于seek
+    bool flush();
 private:
     // JNI相关
     JavaVM* javaVM;
@@ -42,6 +41,7 @@ private:
     jmethodID getPtsMethod;
     jmethodID signalEndOfInputStreamMethod;
     jmethodID releaseMethod;
+    jmethodID flushMethod;
     // DecodedFrame相关方法
     jmethodID getBufferMethod;
     jmethodID getOutputBufferIdMethod;
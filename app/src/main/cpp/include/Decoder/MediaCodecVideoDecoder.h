@@ -9,9 +9,6 @@
 #include "Decoder/MediaCodecDecoderWrapper.h"
 #include <string>
 
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "C++_MediaCodecVideoDecoder", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "C++_MediaCodecVideoDecoder", __VA_ARGS__)
-
 class MediaCodecVideoDecoder : public IVideoDecoder {
 public:
     MediaCodecVideoDecoder();
@@ -22,6 +19,8 @@ public:
 
     int ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) override;
 
+    void flush() override;
+
     bool isReadying() override;
 
     bool configure(const DecoderConfig& config) override;
@@ -12,7 +12,7 @@ extern "C" {
 };
 #include <memory>
 #include <thread>
-#include <android/log.h>
+#include "platform/Log.h"
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
@@ -20,50 +20,53 @@ extern "C" {
 #include "core/SafeQueue.hpp"
 #include "core/PerformceTimer.hpp"
 
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "FFmpegDemuxer", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "FFmpegDemuxer", __VA_ARGS__)
-
+/**
+ * 单个AVFormatContext同时负责音频流和视频流，
+ * ReceivePacket返回任意流的packet，由调用方根据stream_index分发
+ * */
 class FFmpegDemuxer {
 public:
-    enum struct DemuxerType { AUDIO, VIDEO, NONE};
-
-    FFmpegDemuxer(DemuxerType type = DemuxerType::AUDIO);
+    FFmpegDemuxer();
     ~FFmpegDemuxer();
 
     bool open(const std::string& filePath);
 
-    // 控制
-    void seekTo(double position);
+    // 跳转到position(秒)之前最近的关键帧，只能在读取packet的线程调用
+    bool seekTo(double position);
 
+    // 读取下一个packet（音频或视频），返回av_read_frame的结果
     int ReceivePacket(AVPacket* packet);
 
     double getDuration() const { return duration; };
+    // 文件起始时间(秒)，pts换算成秒后需要减去它才是播放位置
+    double getStartTime() const;
 
     // for decoder
-    AVCodecParameters* getCodecParameters();
-    AVStream* getAVStream() { return fmt_ctx->streams[streamIdx]; }
+    AVCodecParameters* getAudioCodecParameters() const;
+    AVCodecParameters* getVideoCodecParameters() const;
+    AVStream* getVideoStream() const;
+
+    int getAudioStreamIndex() const { return audioStreamIdx; }
+    int getVideoStreamIndex() const { return videoStreamIdx; }
 
     bool isReadying() const { return isReady; }
     bool hasVideo() const;
     bool hasAudio() const;
-    AVRational getTimeBase() const;
+    AVRational getAudioTimeBase() const;
+    AVRational getVideoTimeBase() const;
 
 private:
     AVFormatContext* fmt_ctx;
 
-    int streamIdx;
+    int audioStreamIdx;
+    int videoStreamIdx;
 
     // 状态
-    std::atomic<bool> isSeekRequested{false};
     std::atomic<bool> isReady{false};
 
-    double seekPosition{};
-
     std::string filePath;
     double duration;
 
-    DemuxerType type;
-
     void release();
 };
 #endif //GLMEDIAKIT_FFMPEGDEMUXER_H
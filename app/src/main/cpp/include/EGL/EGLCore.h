@@ -6,14 +6,10 @@
 #define GLMEDIAKIT_EGLCORE_H
 
 #include <EGL/egl.h>
-#include <android/native_window_jni.h>
-#include <android/log.h>
+#include "platform/Window.h"
+#include "platform/Log.h"
 #include <mutex>
 
-#define LOG_TAG "EGLCore"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-
 class EGLCore {
 public:
     EGLCore();
@@ -23,7 +19,7 @@ public:
     bool init();
 
     // 创建窗口表面
-    EGLSurface createWindowSurface(ANativeWindow* window);
+    EGLSurface createWindowSurface(NativeWindow* window);
 
     // 创建离屏表面（预留接口）
     EGLSurface createOffscreenSurface(int width, int height);
@@ -52,6 +48,6 @@ private:
     EGLSurface eglSurface;
     std::mutex surfaceMtx;
 
-    ANativeWindow* mWindow;
+    NativeWindow* mWindow;
 };
 #endif //GLMEDIAKIT_EGLCORE_H
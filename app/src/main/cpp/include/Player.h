@@ -12,20 +12,23 @@
 #include "Decoder/FFmpegVideoDecoder.h"
 #include "Decoder/FFmpegAudioDecoder.h"
 #include "core/SafeQueue.hpp"
+#include "core/SPSCQueue.hpp"
+#include "core/FramePool.hpp"
 #include "Demuxer/FFmpegDemuxer.h"
-#include "SLAudioPlayer.h"
+#include "interface/IAudioSink.h"
+#include "platform/Platform.h"
 #include "core/MediaSynchronizer.hpp"
+#include "core/PlaybackStats.hpp"
+#include "core/FramePacing.hpp"
+#include "core/LateFrameController.hpp"
 #include "Reader/FFmpegReader.h"
 
 #include <memory>
-#include <android/log.h>
+#include "platform/Log.h"
 #include <mutex>
 #include <condition_variable>
 #include <string>
 
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "Player", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "Player", __VA_ARGS__)
-
 class Player {
 public:
     enum struct PlayerState {
@@ -50,20 +53,41 @@ public:
     bool pause();
     bool stop();
     bool release();
-    bool seekTo(double position);
+    bool seekTo(double position, FFmpegReader::SeekMode mode = FFmpegReader::SeekMode::ACCURATE);
     bool resume();
+    // 播放速度0.25~4.0，音频变速不变调
+    bool setPlaybackRate(float rate);
+    float getPlaybackRate() const { return playbackRate; }
+
+    // 拖动进度条: 期间不改变播放状态，音频暂停，视频只显示目标位置附近的关键帧
+    bool beginScrub();
+    bool scrubTo(double position);
+    bool endScrub();
 //
     // 状态查询
     Player::PlayerState getPlayerState();
     double getDuration() const;
     bool isPlaying() const;
+    double getLastSeekLatencyMs() const;
+    // 运行时统计快照: 队列深度、帧数、音视频偏差及解码/上传耗时的分位数，切换文件时清零
+    PlaybackStats::Snapshot getStats() const;
+    // 帧节奏报告: 迟到/重复/跳过的帧数和显示间隔分布，切换文件时清零
+    FramePacing::Report getPacingReport() const;
+    // 显示刷新率，用于帧节奏分析，默认60Hz
+    void setDisplayRefreshRate(double hz);
+
+    // 事件追踪(需要以GLMEDIAKIT_TRACE编译)，stopTrace时导出为Chrome trace JSON
+    bool startTrace();
+    bool stopTrace(const std::string& path);
 
     // 获取视频信息
     int getVideoWidth() const;
     int getVideoHeight() const;
+    // 视频解码器的选择结果，例如"hardware(profile 110 not supported) -> FFmpeg(ok)"
+    std::string getVideoDecoderInfo() const;
 
     //
-    void attachSurface(ANativeWindow* window);
+    void attachSurface(NativeWindow* window);
     void detachSurface();
     void surfaceSizeChanged(int width, int height);
 
@@ -74,13 +98,18 @@ private:
     std::unique_ptr<EGLCore> eglCore;
     std::unique_ptr<IRenderer> renderer;
     std::unique_ptr<RenderThread> renderThread;
-    std::unique_ptr<SLAudioPlayer> audioPlayer;
+    std::unique_ptr<IAudioSink> audioPlayer;
     std::unique_ptr<FFmpegReader> reader;
     std::shared_ptr<MediaSynchronizer> synchronizer;
+    std::shared_ptr<PlaybackStats> playbackStats;
+    std::shared_ptr<FramePacing> framePacing;
+    std::shared_ptr<LateFrameController> lateFrameController;
 
     PlayerState currentState;
     PlayerState previousState; // 用于Seeking后恢复
     std::mutex stateMtx;
+    // 保护reader指针本身: 切换文件和释放时替换reader，统计等getter可能在其他线程(JNI)同时读取
+    mutable std::mutex readerMtx;
     std::condition_variable stateCond;
 
     bool isAttachSurface;
@@ -89,10 +118,20 @@ private:
 
     std::string mediaPath;
     double seekPosition{};
+    FFmpegReader::SeekMode seekMode{FFmpegReader::SeekMode::ACCURATE};
+    bool isScrubbing{false};
+    double scrubPosition{};
     std::atomic<bool> fileChanged{false};
+    float playbackRate{1.0f};
+    // 按轨道选择的主时钟，拖动进度条结束后恢复
+    MediaSynchronizer::SyncSource syncMaster{MediaSynchronizer::SyncSource::AUDIO};
+    bool hasAudioOutput{false};
     // 相关队列
-    std::shared_ptr<SafeQueue<AVFrame*>> videoFrameQueue;
-    std::shared_ptr<SafeQueue<AVFrame*>> audioFrameQueue;
+    std::shared_ptr<SPSCQueue<AVFrame*>> videoFrameQueue;
+    std::shared_ptr<SPSCQueue<AVFrame*>> audioFrameQueue;
+    // 帧队列中AVFrame的复用池
+    std::shared_ptr<FramePool> videoFramePool;
+    std::shared_ptr<FramePool> audioFramePool;
 
     // 状态转换方法
     void changeState(PlayerState newState);
@@ -106,6 +145,7 @@ private:
     void performSeeking();
     void handleCompletion();
     void handleError();
+    void onReaderError(int error);
     void releaseResources();
 
     // 禁止拷贝构造和赋值
@@ -12,38 +12,54 @@ extern "C" {
 };
 #include <memory>
 #include <thread>
-#include <android/log.h>
+#include "platform/Log.h"
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 #include <cstdio>
 
-#include "core/SafeQueue.hpp"
+#include "core/PacketQueue.hpp"
+#include "core/SPSCQueue.hpp"
+#include "core/FramePool.hpp"
+#include "core/FrameQueueSizer.hpp"
 #include "core/PerformceTimer.hpp"
+#include "core/PlaybackStats.hpp"
+#include "core/LateFrameController.hpp"
 
 #include "Demuxer/FFmpegDemuxer.h"
 
 #include "Decoder/FFmpegAudioDecoder.h"
 #include "Decoder/FFmpegVideoDecoder.h"
+#include "Decoder/DecoderFactory.h"
 
-#include "Decoder/MediaCodecVideoDecoder.h"
+#include "platform/Platform.h"
+#include "platform/FFmpegCompat.h"
 
 #include "io/FFmpegPacket.hpp"
 #include "io/FFmpegFrame.hpp"
-#include "io/MediaCodecFrame.hpp"
 
 #include "interface/IMediaData.h"
 #include "interface/IDecoder.h"
 
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "FFmpegReader", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "FFmpegReader", __VA_ARGS__)
-
 class FFmpegReader {
 public:
     enum struct ReaderType { ONLY_VIDEO, ONLY_AUDIO, AUDIO_VIDEO};
-
-    FFmpegReader(std::shared_ptr<SafeQueue<AVFrame*>> videoFrameQueue,
-                      std::shared_ptr<SafeQueue<AVFrame*>> audioFrameQueue,
+    // KEYFRAME: 停在目标位置之前最近的关键帧，最快; ACCURATE: 解码到目标位置，只输出目标帧及之后的帧
+    enum struct SeekMode { KEYFRAME, ACCURATE };
+
+    struct SeekStats {
+        int count{0};
+        double lastMs{0};
+        double avgMs{0};
+        double maxMs{0};
+        int lastSkippedFrames{0};   // 最近一次精确seek中解码后被丢弃的帧数
+    };
+
+    FFmpegReader(std::shared_ptr<SPSCQueue<AVFrame*>> videoFrameQueue,
+                      std::shared_ptr<SPSCQueue<AVFrame*>> audioFrameQueue,
+                      std::shared_ptr<FramePool> videoFramePool,
+                      std::shared_ptr<FramePool> audioFramePool,
                       ReaderType type = ReaderType::AUDIO_VIDEO);
     ~FFmpegReader();
 
@@ -54,66 +70,155 @@ public:
     void pause();
     void resume();
     void stop();
-    void seekTo(double position);
-
-    double getDuration() const { return audioDemuxer->getDuration(); };
-    bool isRunning() const { return !exitRequested && (audioReadThread.joinable() || videoReadThread.joinable()); }
+    // 异步seek，返回新的序号；旧序号的packet/帧由解码线程和消费者各自丢弃，不需要停止整个管线
+    int seekTo(double position, SeekMode mode = SeekMode::ACCURATE);
+    // 最近一次seek从请求到第一帧(有视频时为视频帧)推入帧队列的耗时
+    double getLastSeekLatencyMs() const { return lastSeekLatencyMs; }
+    SeekStats getSeekStats(SeekMode mode);
+
+    // 拖动进度条期间开启: 只解码视频关键帧、不解码音频，每次seek只输出一帧后停止读取。
+    // 结束后调用方需要再seekTo一次，从拖动结束的位置恢复正常解码
+    void setScrubbing(bool enable);
+    bool isScrubbing() const { return scrubbing; }
+
+    double getDuration() const { return demuxer->getDuration(); };
+    // 第一个packet的时间(秒)，TS/HLS等容器不为0。seekTo()的位置从这里算起，帧的pts * time_base包含它
+    double getStartTime() const { return demuxer->getStartTime(); }
+    bool isRunning() const { return !exitRequested && demuxThread.joinable(); }
     bool isReadying() const { return isReady; }
     bool hasVideo() const;
     bool hasAudio() const;
     AVRational getAudioTimeBase() const;
     AVRational getVideoTimeBase() const;
-    int getVideoWidth() const { return videoDecoder->getWidth(); }
-    int getVideoHeight() const { return videoDecoder->getHeight(); }
-
-    int getSampleRate() const { return audioDecoder->getSampleRate(); }
-    int getChannel() const { return audioDecoder->getChannel(); }
-    SampleFormat getSampleFormat() const { return audioDecoder->getSampleFormat(); }
+    // 没有对应轨道时返回0
+    int getVideoWidth() const { return videoDecoder ? videoDecoder->getWidth() : 0; }
+    int getVideoHeight() const { return videoDecoder ? videoDecoder->getHeight() : 0; }
+    // 当前使用的视频解码器(硬解/软解)及选择和回退的原因，可以在任意线程调用。
+    // 选择记录由DecoderFactory加锁复制，解码线程回退时不会读到一半
+    DecoderFactory::Selection getVideoDecoderSelection() const {
+        auto factory = std::atomic_load(&videoDecoderFactory);
+        return factory ? factory->getSelection() : DecoderFactory::Selection();
+    }
+
+    int getSampleRate() const { return audioDecoder ? audioDecoder->getSampleRate() : 0; }
+    int getChannel() const { return audioDecoder ? audioDecoder->getChannel() : 0; }
+    SampleFormat getSampleFormat() const { return audioDecoder ? audioDecoder->getSampleFormat() : SampleFormat::S16; }
+
+    // 预读: 解封装线程最多领先解码多少时长/字节，两个流都达到时长上限或总字节数达到上限时暂停读取
+    void setReadAhead(double seconds, int64_t bytes);
+    BufferLevel getAudioBufferLevel() const { return audioPacketQueue->peekLevel(); }
+    BufferLevel getVideoBufferLevel() const { return videoPacketQueue->peekLevel(); }
+
+    // 播放速度，超过2倍时解码器跳过非参考帧，减少需要解码的帧数
+    void setPlaybackRate(double rate) { playbackRate = rate; }
+
+    // 视频解码器的候选列表，需要在open()之前设置，默认为DecoderFactory::createDefault()
+    void setVideoDecoderFactory(std::unique_ptr<DecoderFactory> factory) {
+        std::atomic_store(&videoDecoderFactory, std::shared_ptr<DecoderFactory>(std::move(factory)));
+    }
+
+    // 运行时统计(读取字节数、解码帧数和耗时)，需要在start()之前设置
+    void setStats(std::shared_ptr<PlaybackStats> stats) { playbackStats = std::move(stats); }
+    // 渲染线程落后时的解码降级(跳过非参考帧/只解码关键帧)，需要在start()之前设置
+    void setLateFrameController(std::shared_ptr<LateFrameController> controller) {
+        lateFrameController = std::move(controller);
+    }
+    // 读取持续失败时在解封装线程回调(参数为AVERROR错误码)，需要在start()之前设置
+    void setErrorCallback(std::function<void(int)> callback) { errorCallback = std::move(callback); }
+    // 最近一次放弃读取时的错误码，正常时为0
+    int getReadError() const { return readError; }
 
 private:
-    // 线程
-    std::thread audioReadThread;
-    std::thread videoReadThread;
+    // 线程: 一个解封装线程按流分发packet，音视频各自一个解码线程
+    std::thread demuxThread;
+    std::thread audioDecodeThread;
+    std::thread videoDecodeThread;
 
     // 状态
     std::atomic<bool> isPaused{false};
     std::atomic<bool> exitRequested{false};
-    std::atomic<bool> isSeekRequested{false};
     std::atomic<bool> isReady{false};
+    std::atomic<int> readError{0};
+    std::function<void(int)> errorCallback;
+    // 连续读取失败达到该次数后不再重试，重试间隔从10ms倍增到READ_RETRY_MAX_MS
+    static constexpr int MAX_READ_ERRORS = 20;
+    static constexpr int READ_RETRY_MAX_MS = 320;
 
+    std::mutex demuxMtx;
     std::mutex audioMtx;
     std::mutex videoMtx;
+    std::condition_variable demuxPauseCond;
     std::condition_variable audioPauseCond;
     std::condition_variable videoPauseCond;
 
-    double seekPosition{};
+    // seek: 调用方线程只记录目标位置和序号，由解封装线程执行，多次请求只处理最后一次
+    std::atomic<int> seekSerial{0};
+    std::atomic<double> seekPosition{0};
+    std::atomic<int64_t> seekRequestTime{0};
+    std::atomic<int> measuredSerial{0};
+    std::atomic<double> lastSeekLatencyMs{0};
+    std::atomic<SeekMode> seekMode{SeekMode::ACCURATE};
+    std::atomic<bool> scrubbing{false};
+    std::atomic<double> playbackRate{1.0};
+    std::mutex seekStatsMtx;
+    SeekStats seekStats[2];
+    void onFrameOutput(int serial, int skippedFrames);
+    // 精确seek时需要解码到的目标时间(秒，与pts * time_base同一基准)，不需要跳过时返回-1
+    double getSkipTarget(int serial) const;
 
     std::string filePath;
     double duration;
 
     // 组件
-    std::unique_ptr<FFmpegDemuxer> audioDemuxer;
-    std::unique_ptr<FFmpegDemuxer> videoDemuxer;
+    std::unique_ptr<FFmpegDemuxer> demuxer;
     std::unique_ptr<IAudioDecoder> audioDecoder;
     std::unique_ptr<IVideoDecoder> videoDecoder;
+    // open()时创建，其他线程通过std::atomic_load读取
+    std::shared_ptr<DecoderFactory> videoDecoderFactory;
 
     // 数据
-    AVPacket* audioPacket;
-    AVPacket* videoPacket;
     AVFrame* audioFrame;
     AVFrame* videoFrame;
-    std::shared_ptr<SafeQueue<AVFrame*>> audioFrameQueue;
-    std::shared_ptr<SafeQueue<AVFrame*>> videoFrameQueue;
+    // 解封装线程 -> 解码线程, nullptr表示流结束。packet从packetPool获取，解码后或被丢弃时归还
+    std::shared_ptr<PacketPool> packetPool;
+    std::shared_ptr<PacketQueue> audioPacketQueue;
+    std::shared_ptr<PacketQueue> videoPacketQueue;
+    std::shared_ptr<SPSCQueue<AVFrame*>> audioFrameQueue;
+    std::shared_ptr<SPSCQueue<AVFrame*>> videoFrameQueue;
+    // 推入帧队列的AVFrame从池中获取，消费者用完后归还
+    std::shared_ptr<FramePool> audioFramePool;
+    std::shared_ptr<FramePool> videoFramePool;
 
     ReaderType readerType;
+    std::shared_ptr<PlaybackStats> playbackStats;
+    std::shared_ptr<LateFrameController> lateFrameController;
+
+    std::atomic<double> maxBufferDuration{2.0};
+    std::atomic<int64_t> maxBufferBytes{8 * 1024 * 1024};
+    // 时长无法统计(packet没有duration)时，按包个数兜底
+    static constexpr int MAX_BUFFER_PACKETS = 512;
+    // 按通常的缓冲水位(两个队列共约2秒)加上解码线程手中的packet估算，超出时池未命中再分配
+    static constexpr size_t PACKET_POOL_SIZE = 256;
+    static constexpr double FAST_PLAYBACK_RATE = 2.0;
+
+    bool isBufferFull() const;
+
+    // 帧队列容量随缓冲时长和单帧大小调整，只在对应的解码线程中使用
+    FrameQueueSizer audioQueueSizer;
+    FrameQueueSizer videoQueueSizer;
+    void adjustFrameQueue(SPSCQueue<AVFrame*>& queue, FrameQueueSizer& sizer,
+                          const AVFrame* frame, size_t frameBytes, double frameDuration, bool& primed);
 
-    void audioReadThreadFunc();
-    void videoReadThreadFunc();
+    void demuxThreadFunc();
+    void audioDecodeThreadFunc();
+    void videoDecodeThreadFunc();
 
     void releaseAudio();
     void releaseVideo();
 
-    bool extractSPSPPS(AVCodecParameters* codecCtx, std::vector<uint8_t>& sps, std::vector<uint8_t>& pps);
+    DecoderConfig getVideoDecoderConfig();
+    // 解码开始阶段失败时换用下一个候选解码器，没有可用的候选时返回false
+    bool fallbackVideoDecoder(const std::string& reason);
 
     AVBSFContext *m_absCtx = nullptr;
     int OpenBsfCtx();
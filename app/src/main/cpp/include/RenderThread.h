@@ -17,19 +17,20 @@ extern "C" {
 #include "interface/IRenderer.h"
 #include "interface/IMediaData.h"
 #include "EGL/EGLCore.h"
-#include "core/SafeQueue.hpp"
+#include "core/SPSCQueue.hpp"
+#include "core/FramePool.hpp"
 #include "core/IClock.h"
 #include "core/MediaSynchronizer.hpp"
-
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "RenderThread", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "RenderThread", __VA_ARGS__)
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, "RenderThread", __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, "RenderThread", __VA_ARGS__)
+#include "core/PlaybackStats.hpp"
+#include "core/FramePacing.hpp"
+#include "core/LateFrameController.hpp"
+#include "core/PresentationScheduler.hpp"
 
 class RenderThread {
 public:
 
-    RenderThread(std::shared_ptr<SafeQueue<AVFrame*>> frameQueue,
+    RenderThread(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                 std::shared_ptr<FramePool> framePool,
                  std::shared_ptr<MediaSynchronizer> sync);
     ~RenderThread();
 
@@ -43,6 +44,11 @@ public:
     void postTask(const std::function<void()>& task);
     void setSync(const std::shared_ptr<MediaSynchronizer>& sync);
     void setTimeBase(const AVRational& timeBase);
+    void setStats(const std::shared_ptr<PlaybackStats>& stats);
+    void setFramePacing(const std::shared_ptr<FramePacing>& pacing);
+    void setLateFrameController(const std::shared_ptr<LateFrameController>& controller);
+    // 可以在任意线程调用
+    void setRefreshRate(double hz) { scheduler.setRefreshRate(hz); }
 private:
     std::thread thread;
 
@@ -50,6 +56,8 @@ private:
     EGLCore* eglCore;
 
     void renderLoop();
+    // 绘制一帧(上传纹理并提交绘制)，同时统计耗时，返回开始绘制的时间(av_gettime_relative)
+    int64_t drawFrame(AVFrame* frame);
 
     // 状态控制
     std::atomic<bool> isPaused{false};
@@ -66,14 +74,24 @@ private:
     void executeGLTasks();
 
     // Frame数据
-    std::shared_ptr<SafeQueue<AVFrame*>> videoFrameQueue;
+    std::shared_ptr<SPSCQueue<AVFrame*>> videoFrameQueue;
+    // 绘制完成后归还AVFrame
+    std::shared_ptr<FramePool> videoFramePool;
 
     // 视频时间基
     AVRational videoTimeBase{};
     // 视频时钟
     IClock videoClock;
-    // 主时钟控制
+    // 主时钟控制，渲染线程运行中可能被setSync替换，通过std::atomic_load/atomic_store访问
     std::shared_ptr<MediaSynchronizer> synchronizer;
+    // 运行时统计，由Player持有
+    std::shared_ptr<PlaybackStats> playbackStats;
+    // 帧节奏分析，由Player持有
+    std::shared_ptr<FramePacing> framePacing;
+    // 落后时丢帧并通知解码线程降级，由Player持有
+    std::shared_ptr<LateFrameController> lateFrameController;
+    // 按vsync调度每一帧的提交时刻
+    PresentationScheduler scheduler;
 };
 
 
@@ -7,7 +7,7 @@
 
 #include <GLES3/gl3.h>
 #include <EGL/egl.h>
-#include <android/log.h>
+#include "platform/Log.h"
 #include <memory>
 
 #include "Geometry/Geometry.h"
@@ -19,9 +19,6 @@
 #include "Geometry/RotatingTriangle.h"
 #include "Renderer/OffscreenRenderer.h"
 
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "GLRenderer", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "GLRenderer", __VA_ARGS__)
-
 class GLRenderer: public IRenderer{
 public:
 
@@ -6,11 +6,7 @@
 #define GLMEDIAKIT_GEOMETRY_H
 
 #include <GLES3/gl3.h>
-#include <android/log.h>
-
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "Geometry", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "Geometry", __VA_ARGS__)
-
+#include "platform/Log.h"
 
 class Geometry {
 public:
@@ -9,10 +9,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <GLES3/gl3.h>
-#include <android/log.h>
-
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "ImageRenderer", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "ImageRenderer", __VA_ARGS__)
+#include "platform/Log.h"
 
 class ImageRenderer : public IRenderer {
 public:
@@ -6,10 +6,7 @@
 #define GLMEDIAKIT_SHADERMANAGER_H
 
 #include <GLES3/gl3.h>
-#include <android/log.h>
-
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "ShaderManager", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "ShaderManager", __VA_ARGS__)
+#include "platform/Log.h"
 
 class ShaderManager {
 public:
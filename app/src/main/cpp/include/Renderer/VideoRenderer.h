@@ -17,9 +17,6 @@
 #include <condition_variable>
 #include <atomic>
 
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "VideoRenderer", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "VideoRenderer", __VA_ARGS__)
-
 class VideoRenderer : public IRenderer {
 public:
     explicit VideoRenderer();
@@ -7,52 +7,45 @@
 
 extern "C" {
 #include <libavcodec/avcodec.h>
-#include <libavutil/time.h>
-#include <libavformat/avformat.h>
-#include <libswresample/swresample.h>
 };
 
 #include <SLES/OpenSLES.h>
 #include <SLES/OpenSLES_Android.h>
-#include <android/log.h>
-#include <thread>
+#include "platform/Log.h"
 #include <mutex>
-#include <condition_variable>
 #include <atomic>
 
-#include "core/SafeQueue.hpp"
-#include "core/IClock.h"
-#include "core/MediaSynchronizer.hpp"
-#include "interface/IMediaData.h"
-#include "io/FFmpegFrame.hpp"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "SLAudioPlayer", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "SLAudioPlayer", __VA_ARGS__)
+#include "interface/IAudioSink.h"
+#include "AudioFrameConverter.h"
 
-class SLAudioPlayer {
+class SLAudioPlayer : public IAudioSink {
 public:
-    explicit SLAudioPlayer(std::shared_ptr<SafeQueue<AVFrame*>> frameQueue,
+    explicit SLAudioPlayer(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                           std::shared_ptr<FramePool> framePool,
                            std::shared_ptr<MediaSynchronizer> sync);
-    ~SLAudioPlayer();
+    ~SLAudioPlayer() override;
 
     // 初始化OpenSL ES并设置音频参数
-    bool prepare(int sampleRate, int channels, AVSampleFormat format);
+    bool prepare(int sampleRate, int channels, AVSampleFormat format) override;
 
     // 控制播放
-    void start();
-    void pause();
-    void resume();
-    void stop();
-    void release();
+    void start() override;
+    void pause() override;
+    void resume() override;
+    void stop() override;
+    void release() override;
 
     // 音量控制
-    void setVolume(float vol);
-    float getVolume() const { return volume.load(); }
+    void setVolume(float vol) override;
+    float getVolume() const override { return converter.getVolume(); }
 
     // 重置重采样缓冲区
-    void resetResampleBuffer() { availableSamples = 0; }
-    bool isReadying() { return isReady; }
+    void resetResampleBuffer() { converter.resetResampleBuffer(); }
+    bool isReadying() override { return isReady; }
 
-    void setTimeBase(const AVRational& timeBase);
+    void setTimeBase(const AVRational& timeBase) override;
+    void setPlaybackRate(float rate) override { converter.setPlaybackRate(rate); }
+    double getLatency() override;
 private:
     // OpenSLES 对象
     // 引擎对象
@@ -70,36 +63,14 @@ private:
     static const int BUFFER_SIZE = 8192;  // 缓冲区大小，根据延迟要求调整
     uint8_t* audioBuffer;
 
-    // 音频数据源
-    std::shared_ptr<SafeQueue<AVFrame*>> audioFrameQueue;
+    // 取帧、重采样和音频时钟
+    AudioFrameConverter converter;
     std::mutex mutex;
     std::atomic<bool> isRunning{false};
     std::atomic<bool> isReady{false};
-    std::atomic<float> volume{1.0f};
-
-    // 音频参数
-    int inSampleRate = 0;
-    int inChannels = 0;
-    AVSampleFormat inFormat = AV_SAMPLE_FMT_NONE;
-    int64_t inChannelLayout = 0;
 
     int outSampleRate = 44100;  // 输出采样率
-    int outChannels = 2;        // 立体声输出
-    AVSampleFormat outFormat = AV_SAMPLE_FMT_S16;  // 16位PCM
-    int64_t outChannelLayout = AV_CH_LAYOUT_STEREO;
-
-    // 重采样
-    SwrContext* swrContext = nullptr;
-    uint8_t* resampleBuffer = nullptr;
-    int resampleBufferSize = 0;
-    int availableSamples = 0;
-
-    // 音频时钟
-    IClock audioClock;
-    // 时间基
-    AVRational AudioTimeBase = {0, 0};
-    // 主时钟同步控制
-    std::shared_ptr<MediaSynchronizer> synchronizer;
+    int outChannels = 2;        // 立体声输出, 16位PCM
 
     // 静态回调函数
     static void bufferQueueCallback(SLAndroidSimpleBufferQueueItf bq, void* context);
@@ -109,12 +80,6 @@ private:
 
     // 填充音频缓冲区
     void fillBuffer(uint8_t* buffer, int size);
-
-    // 从解码帧中提取音频并重采样
-    int resampleAudio(AVFrame* frame, uint8_t* outBuffer, int outSize);
-
-    // 应用音量
-    void applyVolume(int16_t* buffer, int numSamples);
 };
 
 #endif //GLMEDIAKIT_SLAUDIOPLAYER_H
@@ -9,13 +9,10 @@
 #include <GLES3/gl3.h>
 #include <string>
 #include <unordered_map>
-#include <android/log.h>
+#include "platform/Log.h"
 #include <android/bitmap.h>
 #include <vector>
 
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "TextureManager", __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, "TextureManager", __VA_ARGS__)
-
 class TextureManager {
 public:
     TextureManager();
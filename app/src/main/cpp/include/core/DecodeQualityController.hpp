@@ -0,0 +1,137 @@
+//
+// Created by Weichuandong on 2025/5/4.
+//
+
+#ifndef GLMEDIAKIT_DECODEQUALITYCONTROLLER_HPP
+#define GLMEDIAKIT_DECODEQUALITYCONTROLLER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "platform/Log.h"
+
+/**
+ * 软解跟不上时的逐级降质
+ *
+ * 解码线程每送入一个packet调用onPacket()，给出这个packet在解码器中花费的时间(SendPacket和随后的ReceiveFrame)，
+ * 与当前的帧间隔(按播放速度换算)相比得到负载，取指数平均:
+ * - 负载超过DEGRADE_LOAD且距上次调整至少MIN_DWELL_US时降一级:
+ *   FULL -> SKIP_LOOP_FILTER_NONREF(非参考帧不做环路滤波) -> SKIP_LOOP_FILTER_ALL(所有帧不做环路滤波)
+ *   -> LOWRES(半分辨率解码，只有支持lowres的解码器) -> SKIP_NONREF(跳过非参考帧)
+ * - 负载持续低于RECOVER_LOAD达到recoverHold时升一级。升级后很快又降级(抖动)说明余量不够，
+ *   recoverHold加倍(最多MAX_RECOVER_HOLD_US)，稳定一段时间后恢复到初始值
+ * 每次调整后平均值重新累计，至少MIN_SAMPLES个样本后才会再次调整。
+ *
+ * 级别由解码线程调整，getLevel()可以在任意线程调用。时间(微秒)由调用方传入，便于用合成数据验证。
+ * */
+class DecodeQualityController {
+public:
+    enum class Level { FULL, SKIP_LOOP_FILTER_NONREF, SKIP_LOOP_FILTER_ALL, LOWRES, SKIP_NONREF };
+
+    static constexpr double DEGRADE_LOAD = 0.9;
+    static constexpr double RECOVER_LOAD = 0.5;
+    static constexpr int MIN_SAMPLES = 8;
+    static constexpr int64_t MIN_DWELL_US = 500000;
+    static constexpr int64_t RECOVER_HOLD_US = 2000000;
+    static constexpr int64_t MAX_RECOVER_HOLD_US = 32000000;
+
+    static const char* getLevelName(Level level) {
+        switch (level) {
+            case Level::FULL:
+                return "full";
+            case Level::SKIP_LOOP_FILTER_NONREF:
+                return "skip loop filter (non-ref)";
+            case Level::SKIP_LOOP_FILTER_ALL:
+                return "skip loop filter (all)";
+            case Level::LOWRES:
+                return "lowres";
+            case Level::SKIP_NONREF:
+                return "skip non-ref frames";
+        }
+        return "unknown";
+    }
+
+    // 解码器不支持lowres时跳过这一级
+    void setLowresAvailable(bool available) { lowresAvailable = available; }
+
+    Level getLevel() const { return level.load(std::memory_order_relaxed); }
+
+    double getLoad() const { return samples > 0 ? load : 0; }
+
+    // decodeUs: 这个packet在解码器中花费的时间，frameIntervalUs: 当前播放速度下的帧间隔。级别变化时返回true
+    bool onPacket(int64_t decodeUs, int64_t frameIntervalUs, int64_t nowUs) {
+        if (frameIntervalUs <= 0) return false;
+        const double sample = (double)decodeUs / frameIntervalUs;
+        load = samples == 0 ? sample : load + (sample - load) * EWMA_ALPHA;
+        samples++;
+        if (samples < MIN_SAMPLES) return false;
+
+        const Level current = getLevel();
+        if (load > DEGRADE_LOAD) {
+            belowSinceUs = -1;
+            if (current == Level::SKIP_NONREF || nowUs - lastChangeUs < MIN_DWELL_US) return false;
+            // 升级后不久又降级，下次升级需要等更久
+            if (lastRecoverUs >= 0 && nowUs - lastRecoverUs < recoverHoldUs * 2) {
+                recoverHoldUs = std::min(recoverHoldUs * 2, MAX_RECOVER_HOLD_US);
+            }
+            lastDegradeUs = nowUs;
+            return setLevel(step(current, 1), nowUs);
+        }
+
+        if (load < RECOVER_LOAD && current != Level::FULL) {
+            if (belowSinceUs < 0) belowSinceUs = nowUs;
+            if (nowUs - belowSinceUs < recoverHoldUs || nowUs - lastChangeUs < MIN_DWELL_US) return false;
+            // 距上次降级已经很久，抖动的惩罚不再保留
+            if (nowUs - lastDegradeUs > recoverHoldUs * 4) recoverHoldUs = RECOVER_HOLD_US;
+            lastRecoverUs = nowUs;
+            return setLevel(step(current, -1), nowUs);
+        }
+        if (load >= RECOVER_LOAD) belowSinceUs = -1;
+        return false;
+    }
+
+    // seek之后关键帧较多，之前的平均值不再有参考意义，级别保持不变
+    void resetLoad() {
+        samples = 0;
+        load = 0;
+        belowSinceUs = -1;
+    }
+
+private:
+    static constexpr double EWMA_ALPHA = 0.1;
+
+    std::atomic<Level> level{Level::FULL};
+    bool lowresAvailable{false};
+
+    // 只在解码线程访问
+    double load{0};
+    int samples{0};
+    int64_t lastChangeUs{INT64_MIN / 2};
+    int64_t lastRecoverUs{-1};
+    int64_t lastDegradeUs{INT64_MIN / 2};
+    int64_t belowSinceUs{-1};
+    int64_t recoverHoldUs{RECOVER_HOLD_US};
+
+    Level step(Level current, int direction) const {
+        int next = static_cast<int>(current) + direction;
+        if (!lowresAvailable && next == static_cast<int>(Level::LOWRES)) next += direction;
+        next = std::max(0, std::min(next, static_cast<int>(Level::SKIP_NONREF)));
+        return static_cast<Level>(next);
+    }
+
+    bool setLevel(Level newLevel, int64_t nowUs) {
+        const Level old = getLevel();
+        if (newLevel == old) return false;
+        LOGI_TAG("DecodeQualityController", "decode quality %s -> %s, load %.2f, recover hold %.1fS",
+                 getLevelName(old), getLevelName(newLevel), load, recoverHoldUs / 1000000.0);
+        level.store(newLevel, std::memory_order_relaxed);
+        lastChangeUs = nowUs;
+        samples = 0;
+        load = 0;
+        belowSinceUs = -1;
+        return true;
+    }
+};
+
+#endif //GLMEDIAKIT_DECODEQUALITYCONTROLLER_HPP
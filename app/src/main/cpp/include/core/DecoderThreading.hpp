@@ -0,0 +1,124 @@
+//
+// Created by Weichuandong on 2025/4/30.
+//
+
+#ifndef GLMEDIAKIT_DECODERTHREADING_HPP
+#define GLMEDIAKIT_DECODERTHREADING_HPP
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+};
+
+#include <algorithm>
+#include <string>
+
+/**
+ * FFmpeg软解的线程策略: 根据CPU核数、分辨率、解码器能力和延迟要求选择帧/片级多线程和线程数
+ *
+ * - 帧级多线程(FF_THREAD_FRAME)加速比最好，但每多一个线程输出就多延迟一帧
+ * - 片级多线程(FF_THREAD_SLICE)不增加延迟，但只有码流分成多个slice/tile时才有效
+ *
+ * 线程数按分辨率取需要的数量(分辨率越高单帧工作量越大)，再受可用核数限制:
+ * 核数大于2时留一个核给渲染、解封装和音频线程，避免在4核设备上与它们争抢。
+ * VOD优先帧级多线程；LIVE(低延迟)时帧级多线程的线程数不超过maxDelayFrames + 1，
+ * 不允许额外延迟时使用片级多线程，解码器都不支持时单线程解码。
+ * */
+class DecoderThreading {
+public:
+    enum class Latency { VOD, LIVE };
+
+    struct Input {
+        int cores{1};
+        int width{0};
+        int height{0};
+        AVCodecID codecId{AV_CODEC_ID_NONE};
+        bool frameThreads{false};   // 解码器支持AV_CODEC_CAP_FRAME_THREADS
+        bool sliceThreads{false};   // 解码器支持AV_CODEC_CAP_SLICE_THREADS
+        Latency latency{Latency::VOD};
+        int maxDelayFrames{0};      // LIVE时允许多线程带来的额外延迟(帧)
+    };
+
+    struct Choice {
+        int threadCount{1};
+        int threadType{0};          // FF_THREAD_FRAME / FF_THREAD_SLICE，单线程时为0
+
+        // 帧级多线程带来的额外输出延迟(帧)
+        int delayFrames() const { return threadType == FF_THREAD_FRAME ? threadCount - 1 : 0; }
+    };
+
+    // 帧级多线程超过8个线程后收益很小，延迟却继续增加
+    static constexpr int MAX_THREADS = 8;
+
+    static Choice choose(const Input& in) {
+        Choice choice;
+        const int wanted = std::min(threadsForResolution(in.width, in.height, in.codecId), availableCores(in.cores));
+        if (wanted <= 1) return choice;
+
+        const bool lowLatency = in.latency == Latency::LIVE;
+        const int frameLimit = lowLatency ? std::max(0, in.maxDelayFrames) + 1 : MAX_THREADS;
+        if (in.frameThreads && frameLimit > 1) {
+            choice.threadType = FF_THREAD_FRAME;
+            choice.threadCount = std::min(wanted, frameLimit);
+        } else if (in.sliceThreads) {
+            choice.threadType = FF_THREAD_SLICE;
+            choice.threadCount = wanted;
+        }
+        return choice;
+    }
+
+    // 从解码器能力填充Input
+    static Input describe(const AVCodec* codec, const AVCodecParameters* par, int cores, Latency latency) {
+        Input in;
+        in.cores = cores;
+        in.width = par->width;
+        in.height = par->height;
+        in.codecId = par->codec_id;
+        in.frameThreads = (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS) != 0;
+        in.sliceThreads = (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS) != 0;
+        in.latency = latency;
+        return in;
+    }
+
+    static const char* typeName(int threadType) {
+        switch (threadType) {
+            case FF_THREAD_FRAME:
+                return "frame";
+            case FF_THREAD_SLICE:
+                return "slice";
+            default:
+                return "none";
+        }
+    }
+
+private:
+    static int availableCores(int cores) {
+        cores = std::max(1, cores);
+        return cores > 2 ? cores - 1 : cores;
+    }
+
+    static int threadsForResolution(int width, int height, AVCodecID codecId) {
+        const long pixels = (long)width * height;
+        int threads;
+        if (pixels <= 0) {
+            threads = 2;                // 未知分辨率
+        } else if (pixels <= 320 * 240) {
+            threads = 1;
+        } else if (pixels <= 854 * 480) {
+            threads = 2;
+        } else if (pixels <= 1280 * 720) {
+            threads = 3;
+        } else if (pixels <= 1920 * 1088) {
+            threads = 4;
+        } else {
+            threads = MAX_THREADS;
+        }
+        // HEVC/AV1/VP9单帧计算量明显大于H.264
+        if (pixels > 854 * 480 && (codecId == AV_CODEC_ID_HEVC || codecId == AV_CODEC_ID_AV1 ||
+                                   codecId == AV_CODEC_ID_VP9)) {
+            threads = std::min(threads * 3 / 2, MAX_THREADS);
+        }
+        return threads;
+    }
+};
+
+#endif //GLMEDIAKIT_DECODERTHREADING_HPP
@@ -0,0 +1,297 @@
+//
+// Created by Weichuandong on 2025/4/24.
+//
+
+#ifndef GLMEDIAKIT_DEFERREDLOG_HPP
+#define GLMEDIAKIT_DEFERREDLOG_HPP
+
+#include "platform/Log.h"
+
+/**
+ * 延迟格式化的二进制日志，用于每帧都会执行的调试日志
+ *
+ * 热路径上LOGD_DEFERRED只把格式串指针和数值参数写入一个无锁的环形缓冲区(不格式化、不做系统调用)，
+ * 后台线程每100ms取出记录，格式化后再交给__android_log_print。
+ *
+ * - 格式串和TAG必须是字符串字面量(只保存指针)
+ * - 参数只支持整数、枚举、浮点数和指针，最多6个；字符串参数请使用LOGD
+ * - 缓冲区满时丢弃新记录，后台线程会输出丢弃的条数
+ * - 日志级别高于DEBUG时LOGD_DEFERRED展开为空，和LOGD一样不产生代码
+ * */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+class DeferredLog {
+public:
+    static constexpr int MAX_ARGS = 6;
+    static constexpr size_t CAPACITY = 2048;        // 必须是2的幂
+    static constexpr int FLUSH_INTERVAL_MS = 100;
+
+    template<typename... Args>
+    static void record(int priority, const char* tag, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many arguments for deferred log");
+        instance().push(priority, tag, format, args...);
+    }
+
+    // 立即输出缓冲区中的全部记录，可以在任意线程调用
+    static void flush() {
+        instance().drain();
+    }
+
+    static uint64_t getDroppedCount() {
+        return instance().dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum ArgType : uint8_t { ARG_INT, ARG_UINT, ARG_DOUBLE, ARG_POINTER };
+
+    union Arg {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const void* p;
+    };
+
+    struct Record {
+        std::atomic<uint64_t> sequence{0};
+        uint64_t timestampNs{0};
+        const char* tag{nullptr};
+        const char* format{nullptr};
+        Arg args[MAX_ARGS]{};
+        uint8_t types[MAX_ARGS]{};
+        uint8_t argCount{0};
+        uint8_t priority{0};
+    };
+
+    Record ring[CAPACITY];
+    // 多个线程写入(有界MPMC队列的写端)，只有一个消费者
+    alignas(64) std::atomic<uint64_t> enqueuePos{0};
+    alignas(64) uint64_t dequeuePos{0};
+    std::atomic<uint64_t> dropped{0};
+    uint64_t reportedDropped{0};
+
+    std::mutex drainMtx;            // 保证同时只有一个消费者
+    std::mutex threadMtx;
+    std::condition_variable exitCond;
+    std::thread flushThread;
+    bool exitRequested{false};
+
+    DeferredLog() {
+        for (size_t i = 0; i < CAPACITY; ++i) {
+            ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        // 第一次记录时创建单例，同时启动后台线程
+        flushThread = std::thread(&DeferredLog::flushThreadFunc, this);
+    }
+
+    ~DeferredLog() {
+        {
+            std::lock_guard<std::mutex> lock(threadMtx);
+            exitRequested = true;
+        }
+        exitCond.notify_all();
+        if (flushThread.joinable()) {
+            flushThread.join();
+        }
+        drain();
+    }
+
+    static DeferredLog& instance() {
+        static DeferredLog log;
+        return log;
+    }
+
+    template<typename T>
+    static void encode(T value, Arg& arg, uint8_t& type) {
+        using V = typename std::decay<T>::type;
+        static_assert(!std::is_same<V, const char*>::value && !std::is_same<V, char*>::value,
+                      "deferred log can't keep strings, use LOGD instead");
+        if constexpr (std::is_floating_point<V>::value) {
+            arg.d = (double)value;
+            type = ARG_DOUBLE;
+        } else if constexpr (std::is_pointer<V>::value) {
+            arg.p = (const void*)value;
+            type = ARG_POINTER;
+        } else if constexpr (std::is_enum<V>::value) {
+            arg.i = (int64_t)value;
+            type = ARG_INT;
+        } else if constexpr (std::is_unsigned<V>::value) {
+            arg.u = (uint64_t)value;
+            type = ARG_UINT;
+        } else {
+            static_assert(std::is_integral<V>::value, "unsupported deferred log argument");
+            arg.i = (int64_t)value;
+            type = ARG_INT;
+        }
+    }
+
+    template<typename... Args>
+    void push(int priority, const char* tag, const char* format, Args... args) {
+        uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Record* slot;
+        for (;;) {
+            slot = &ring[pos & (CAPACITY - 1)];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            int64_t diff = (int64_t)sequence - (int64_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                // 缓冲区已满
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->timestampNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        slot->tag = tag;
+        slot->format = format;
+        slot->priority = (uint8_t)priority;
+        slot->argCount = (uint8_t)sizeof...(Args);
+        int index = 0;
+        ((encode(args, slot->args[index], slot->types[index]), ++index), ...);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    void drain() {
+        std::lock_guard<std::mutex> lock(drainMtx);
+        char message[512];
+        for (;;) {
+            Record& slot = ring[dequeuePos & (CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+
+            format(slot, message, sizeof(message));
+            __android_log_print(slot.priority, slot.tag, "[%.6f] %s", slot.timestampNs / 1e9, message);
+
+            slot.sequence.store(dequeuePos + CAPACITY, std::memory_order_release);
+            ++dequeuePos;
+        }
+
+        uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+        if (droppedNow != reportedDropped) {
+            __android_log_print(ANDROID_LOG_WARN, "DeferredLog", "dropped %llu records, buffer full",
+                                (unsigned long long)(droppedNow - reportedDropped));
+            reportedDropped = droppedNow;
+        }
+    }
+
+    void flushThreadFunc() {
+        std::unique_lock<std::mutex> lock(threadMtx);
+        while (!exitRequested) {
+            exitCond.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+    // 逐个转换说明符格式化，整数统一按64位输出，参数类型与说明符不一致时按说明符转换
+    static void format(const Record& record, char* out, size_t size) {
+        size_t len = 0;
+        int argIndex = 0;
+        const char* p = record.format;
+
+        auto append = [&](const char* text) {
+            while (*text && len + 1 < size) out[len++] = *text++;
+        };
+
+        while (*p && len + 1 < size) {
+            if (*p != '%') {
+                out[len++] = *p++;
+                continue;
+            }
+            if (p[1] == '%') {
+                out[len++] = '%';
+                p += 2;
+                continue;
+            }
+
+            char spec[32];
+            size_t specLen = 0;
+            spec[specLen++] = *p++;
+            while (*p && strchr("-+ #0123456789.", *p) && specLen < 24) spec[specLen++] = *p++;
+            while (*p && strchr("hlLqjzt", *p)) p++;
+            char conversion = *p;
+            if (!conversion) break;
+            p++;
+
+            if (argIndex >= record.argCount) {
+                append("<?>");
+                continue;
+            }
+            const Arg& arg = record.args[argIndex];
+            const uint8_t type = record.types[argIndex];
+            argIndex++;
+
+            int written = -1;
+            switch (conversion) {
+                case 'd': case 'i': {
+                    long long value = type == ARG_DOUBLE ? (long long)arg.d : (long long)arg.i;
+                    memcpy(spec + specLen, "lld", 4);
+                    written = snprintf(out + len, size - len, spec, value);
+                    break;
+                }
+                case 'u': case 'x': case 'X': case 'o': case 'c': {
+                    unsigned long long value = type == ARG_DOUBLE ? (unsigned long long)arg.d : arg.u;
+                    if (conversion == 'c') {
+                        spec[specLen] = 'c';
+                        spec[specLen + 1] = '\0';
+                        written = snprintf(out + len, size - len, spec, (int)value);
+                    } else {
+                        spec[specLen] = 'l';
+                        spec[specLen + 1] = 'l';
+                        spec[specLen + 2] = conversion;
+                        spec[specLen + 3] = '\0';
+                        written = snprintf(out + len, size - len, spec, value);
+                    }
+                    break;
+                }
+                case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                    double value = type == ARG_DOUBLE ? arg.d :
+                                   type == ARG_UINT ? (double)arg.u : (double)arg.i;
+                    spec[specLen] = conversion;
+                    spec[specLen + 1] = '\0';
+                    written = snprintf(out + len, size - len, spec, value);
+                    break;
+                }
+                case 'p':
+                    spec[specLen] = 'p';
+                    spec[specLen + 1] = '\0';
+                    written = snprintf(out + len, size - len, spec, arg.p);
+                    break;
+                default:
+                    append("<?>");
+                    break;
+            }
+            if (written > 0) {
+                len += std::min((size_t)written, size - len - 1);
+            }
+        }
+        out[len] = '\0';
+    }
+};
+
+#if LOG_IS_ENABLED(VERBOSE)
+#define LOGV_DEFERRED(...) DeferredLog::record(ANDROID_LOG_VERBOSE, LOG_TAG, __VA_ARGS__)
+#else
+#define LOGV_DEFERRED(...) ((void)0)
+#endif
+
+#if LOG_IS_ENABLED(DEBUG)
+#define LOGD_DEFERRED(...) DeferredLog::record(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#else
+#define LOGD_DEFERRED(...) ((void)0)
+#endif
+
+#endif //GLMEDIAKIT_DEFERREDLOG_HPP
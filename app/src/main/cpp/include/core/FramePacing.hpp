@@ -0,0 +1,143 @@
+//
+// Created by Weichuandong on 2025/4/25.
+//
+
+#ifndef GLMEDIAKIT_FRAMEPACING_HPP
+#define GLMEDIAKIT_FRAMEPACING_HPP
+
+#include "core/PlaybackStats.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+
+/**
+ * 渲染线程的帧节奏(frame pacing)分析
+ *
+ * 每一帧由渲染线程提交三个时间点(微秒，av_gettime_relative):
+ * - intended: 按主时钟换算的该帧应当显示的时间，即 同步时刻 + (视频pts - 主时钟)
+ * - draw:     开始上传纹理并绘制的时间
+ * - swap:     swapBuffers返回的时间，近似认为是帧交给显示系统的时间
+ *
+ * 以显示刷新周期为单位在线统计:
+ * - 迟到帧: swap比intended晚超过一个刷新周期
+ * - 相邻两帧实际显示间隔(刷新周期数，四舍五入)与按pts差值应有的间隔比较，
+ *   多出的周期计为重复帧(上一帧被多显示了)，少掉的周期计为跳过帧(内容没有被显示出来)，
+ *   两者不一致的帧计为卡顿帧
+ * - 显示间隔的分布直方图(0、1、2、3、4、5+个刷新周期)，节奏均匀时集中在一个桶里
+ *
+ * 只有渲染线程写入，计数器使用relaxed原子变量，其他线程通过report()读取近似一致的快照。
+ * seek、暂停等造成的时间线不连续由调用者通过markDiscontinuity()告知，下一帧不参与间隔统计。
+ * */
+class FramePacing {
+public:
+    static constexpr int INTERVAL_BUCKETS = 6;
+
+    struct Report {
+        double refreshIntervalMs{0};
+        uint64_t framesPresented{0};
+        uint64_t lateFrames{0};
+        uint64_t jankFrames{0};
+        uint64_t repeatedFrames{0};
+        uint64_t skippedFrames{0};
+        // 下标为显示间隔的刷新周期数，最后一个桶包含5个及以上
+        uint64_t intervalHistogram[INTERVAL_BUCKETS]{};
+        PlaybackStats::Percentiles lateness;    // swap - intended，提前显示记为0
+        PlaybackStats::Percentiles swapTime;    // swap - draw
+    };
+
+    // 由Java层Display.getRefreshRate()设置，默认60Hz
+    void setRefreshRate(double hz) {
+        if (hz <= 0) return;
+        refreshIntervalUs.store((int64_t)(1000000.0 / hz), std::memory_order_relaxed);
+    }
+
+    void markDiscontinuity() {
+        hasPrevious = false;
+    }
+
+    void onFramePresented(double pts, int64_t intendedUs, int64_t drawUs, int64_t swapUs) {
+        const int64_t refreshUs = refreshIntervalUs.load(std::memory_order_relaxed);
+        const int64_t lateUs = swapUs - intendedUs;
+
+        framesPresented.fetch_add(1, std::memory_order_relaxed);
+        if (lateUs > refreshUs) {
+            lateFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+        lateness.record(lateUs);
+        swapTime.record(swapUs - drawUs);
+
+        const double ptsDelta = pts - previousPts;
+        if (hasPrevious && ptsDelta > 0 && ptsDelta < MAX_CONTENT_INTERVAL) {
+            const int64_t intended = std::llround(ptsDelta * 1000000 / refreshUs);
+            const int64_t actual = std::llround((double)(swapUs - previousSwapUs) / refreshUs);
+
+            intervals[actual < INTERVAL_BUCKETS ? actual : INTERVAL_BUCKETS - 1]
+                    .fetch_add(1, std::memory_order_relaxed);
+            if (actual > intended) {
+                repeatedFrames.fetch_add((uint64_t)(actual - intended), std::memory_order_relaxed);
+                jankFrames.fetch_add(1, std::memory_order_relaxed);
+            } else if (actual < intended) {
+                skippedFrames.fetch_add((uint64_t)(intended - actual), std::memory_order_relaxed);
+                jankFrames.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        previousPts = pts;
+        previousSwapUs = swapUs;
+        hasPrevious = true;
+    }
+
+    Report report() const {
+        Report r;
+        r.refreshIntervalMs = refreshIntervalUs.load(std::memory_order_relaxed) / 1000.0;
+        r.framesPresented = framesPresented.load(std::memory_order_relaxed);
+        r.lateFrames = lateFrames.load(std::memory_order_relaxed);
+        r.jankFrames = jankFrames.load(std::memory_order_relaxed);
+        r.repeatedFrames = repeatedFrames.load(std::memory_order_relaxed);
+        r.skippedFrames = skippedFrames.load(std::memory_order_relaxed);
+        for (int i = 0; i < INTERVAL_BUCKETS; ++i) {
+            r.intervalHistogram[i] = intervals[i].load(std::memory_order_relaxed);
+        }
+        r.lateness = PlaybackStats::toPercentiles(lateness);
+        r.swapTime = PlaybackStats::toPercentiles(swapTime);
+        return r;
+    }
+
+    // 与onFramePresented()并发调用时可能残留少量样本，只在切换文件时使用
+    void reset() {
+        framesPresented.store(0, std::memory_order_relaxed);
+        lateFrames.store(0, std::memory_order_relaxed);
+        jankFrames.store(0, std::memory_order_relaxed);
+        repeatedFrames.store(0, std::memory_order_relaxed);
+        skippedFrames.store(0, std::memory_order_relaxed);
+        for (auto& interval : intervals) {
+            interval.store(0, std::memory_order_relaxed);
+        }
+        lateness.reset();
+        swapTime.reset();
+    }
+
+private:
+    // 相邻两帧pts差值超过该值(秒)时认为是不连续，不参与间隔统计
+    static constexpr double MAX_CONTENT_INTERVAL = 1.0;
+
+    std::atomic<int64_t> refreshIntervalUs{16667};
+
+    std::atomic<uint64_t> framesPresented{0};
+    std::atomic<uint64_t> lateFrames{0};
+    std::atomic<uint64_t> jankFrames{0};
+    std::atomic<uint64_t> repeatedFrames{0};
+    std::atomic<uint64_t> skippedFrames{0};
+    std::atomic<uint64_t> intervals[INTERVAL_BUCKETS]{};
+
+    LatencyHistogram lateness;
+    LatencyHistogram swapTime;
+
+    // 只在渲染线程访问
+    bool hasPrevious{false};
+    double previousPts{0};
+    int64_t previousSwapUs{0};
+};
+
+#endif //GLMEDIAKIT_FRAMEPACING_HPP
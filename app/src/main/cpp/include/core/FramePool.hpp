@@ -0,0 +1,104 @@
+//
+// Created by Weichuandong on 2025/4/16.
+//
+
+#ifndef GLMEDIAKIT_FRAMEPOOL_HPP
+#define GLMEDIAKIT_FRAMEPOOL_HPP
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+extern "C" {
+#include <libavutil/frame.h>
+};
+
+/**
+ * 有界的AVFrame壳对象池
+ *
+ * 解码线程acquire()取一个干净的AVFrame，用av_frame_move_ref接管解码结果（只转移引用，不拷贝数据）；
+ * 消费者用完后release()，帧数据的引用被释放，AVFrame本身回到池中。
+ * 池为空时才分配新的AVFrame(未命中)，池满时多余的AVFrame直接释放，稳定播放时每帧不再有堆分配。
+ * */
+class FramePool {
+public:
+    explicit FramePool(size_t capacity = 8) :
+        capacity(capacity)
+    {
+        freeFrames.reserve(capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            AVFrame* frame = av_frame_alloc();
+            if (frame) freeFrames.push_back(frame);
+        }
+    }
+
+    ~FramePool() {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (AVFrame* frame : freeFrames) {
+            av_frame_free(&frame);
+        }
+        freeFrames.clear();
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // 获取一个不引用任何数据的AVFrame
+    AVFrame* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!freeFrames.empty()) {
+                AVFrame* frame = freeFrames.back();
+                freeFrames.pop_back();
+                hitCount.fetch_add(1, std::memory_order_relaxed);
+                return frame;
+            }
+        }
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return av_frame_alloc();
+    }
+
+    // 归还AVFrame，同时释放其引用的帧数据
+    void release(AVFrame* frame) {
+        if (!frame) return;
+        av_frame_unref(frame);
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (freeFrames.size() < capacity) {
+                freeFrames.push_back(frame);
+                return;
+            }
+        }
+        av_frame_free(&frame);
+    }
+
+    uint64_t getHitCount() const { return hitCount.load(std::memory_order_relaxed); }
+    uint64_t getMissCount() const { return missCount.load(std::memory_order_relaxed); }
+
+    size_t getFreeCount() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return freeFrames.size();
+    }
+
+private:
+    const size_t capacity;
+    std::vector<AVFrame*> freeFrames;
+    std::mutex mtx;
+
+    std::atomic<uint64_t> hitCount{0};
+    std::atomic<uint64_t> missCount{0};
+};
+
+// 帧队列中的AVFrame通过opaque携带seek序号，release时av_frame_unref会将其清零
+inline void setFrameSerial(AVFrame* frame, int serial) {
+    frame->opaque = reinterpret_cast<void*>(static_cast<intptr_t>(serial));
+}
+
+inline int getFrameSerial(const AVFrame* frame) {
+    return static_cast<int>(reinterpret_cast<intptr_t>(frame->opaque));
+}
+
+#endif //GLMEDIAKIT_FRAMEPOOL_HPP
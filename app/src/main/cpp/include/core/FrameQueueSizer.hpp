@@ -0,0 +1,89 @@
+//
+// Created by Weichuandong on 2025/4/19.
+//
+
+#ifndef GLMEDIAKIT_FRAMEQUEUESIZER_HPP
+#define GLMEDIAKIT_FRAMEQUEUESIZER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+
+/**
+ * 帧队列容量计算：容量用"缓冲时长 + 内存上限"表示，再根据单帧大小和单帧时长换算成帧数
+ *
+ * 缓冲时长在[lowWindow, highWindow]之间调整：
+ * - 消费者取空队列(欠载)时时长增加到1.5倍
+ * - 连续shrinkInterval秒没有欠载时缩小到0.8倍
+ * 换算出的帧数再受minFrames/maxFrames和memoryCeiling限制。
+ * 只在生产者(解码线程)中调用，不需要加锁。
+ * */
+class FrameQueueSizer {
+public:
+    struct Config {
+        double lowWindow;       // 最小缓冲时长(秒)
+        double highWindow;      // 最大缓冲时长(秒)
+        size_t memoryCeiling;   // 队列中帧数据的内存上限(字节)
+        size_t minFrames;
+        size_t maxFrames;       // 不能超过SPSCQueue构造时的maxCapacity
+        double shrinkInterval;  // 多久没有欠载后开始缩小(秒)
+    };
+
+    explicit FrameQueueSizer(const Config& config) :
+        config(config),
+        window(config.lowWindow),
+        lastGrow(std::chrono::steady_clock::now()),
+        lastUnderrun(lastGrow)
+    {
+
+    }
+
+    // frameBytes: 单帧数据大小; frameDuration: 单帧时长(秒); underrun: 本次push前消费者已经取空了队列
+    size_t update(size_t frameBytes, double frameDuration, bool underrun) {
+        auto now = std::chrono::steady_clock::now();
+
+        if (underrun) {
+            // 同一次欠载会连续触发多帧，间隔太短时不重复放大
+            if (seconds(now - lastGrow) >= MIN_GROW_INTERVAL && window < config.highWindow) {
+                window = std::min(window * 1.5, config.highWindow);
+                lastGrow = now;
+                underrunCount++;
+            }
+            lastUnderrun = now;
+        } else if (seconds(now - lastUnderrun) >= config.shrinkInterval && window > config.lowWindow) {
+            window = std::max(window * 0.8, config.lowWindow);
+            lastUnderrun = now;
+        }
+
+        size_t frames = config.maxFrames;
+        if (frameDuration > 0) {
+            frames = (size_t)std::ceil(window / frameDuration);
+        }
+        if (frameBytes > 0) {
+            frames = std::min(frames, config.memoryCeiling / frameBytes);
+        }
+        capacity = std::min(std::max(frames, config.minFrames), config.maxFrames);
+        return capacity;
+    }
+
+    double getWindow() const { return window; }
+    size_t getCapacity() const { return capacity; }
+    int getUnderrunCount() const { return underrunCount; }
+
+private:
+    static constexpr double MIN_GROW_INTERVAL = 0.5;
+
+    Config config;
+    double window;
+    size_t capacity{0};
+    int underrunCount{0};
+    std::chrono::steady_clock::time_point lastGrow;
+    std::chrono::steady_clock::time_point lastUnderrun;
+
+    static double seconds(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<double>(d).count();
+    }
+};
+
+#endif //GLMEDIAKIT_FRAMEQUEUESIZER_HPP
@@ -9,18 +9,20 @@ extern "C" {
 #include <libavutil/time.h>
 };
 
+// 时间基为单调时钟av_gettime_relative()，不受系统时间调整影响
 struct IClock {
     double pts = 0.0;               // 当前播放时间
-    double lastUpdateTime = 0.0;    // 上次更新的系统时间
+    double lastUpdateTime = 0.0;    // 上次更新的系统时间(秒)
 
     void update(const IClock& clock) {
         this->pts = clock.pts;
         this->lastUpdateTime = clock.lastUpdateTime;
     }
 
-    double getCurrentTime() {
-        double elapsed = av_gettime() / 1000000.0 - lastUpdateTime; // 当前时间与上次更新的时间差
-        return pts + elapsed; // 返回估计的当前时间
+    // speed为播放速度，墙上时间每过1秒，播放时间前进speed秒
+    double getCurrentTime(double speed = 1.0) const {
+        double elapsed = av_gettime_relative() / 1000000.0 - lastUpdateTime; // 当前时间与上次更新的时间差
+        return pts + elapsed * speed; // 返回估计的当前时间
     }
 };
 #endif //GLMEDIAKIT_ICLOCK_H
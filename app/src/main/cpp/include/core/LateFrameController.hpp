@@ -0,0 +1,119 @@
+//
+// Created by Weichuandong on 2025/4/27.
+//
+
+#ifndef GLMEDIAKIT_LATEFRAMECONTROLLER_HPP
+#define GLMEDIAKIT_LATEFRAMECONTROLLER_HPP
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+};
+
+#include <algorithm>
+#include <atomic>
+
+#include "platform/Log.h"
+
+/**
+ * 视频落后时的丢帧策略和对解码器的反馈
+ *
+ * 渲染线程每帧调用onFrame():
+ * - 帧已经落后超过一帧时长(至少40ms)且队列里还有下一帧时，在上传纹理之前直接丢弃。
+ *   连续丢弃不超过MAX_CONSECUTIVE_DROPS帧，保证画面仍然会更新
+ * - 连续落后时逐级提高解码级别: NORMAL -> SKIP_NONREF(解码器跳过非参考帧) -> KEYFRAME_ONLY(只解码关键帧)，
+ *   落后超过KEYFRAME_LATENESS时直接进入KEYFRAME_ONLY；连续按时的帧足够多时逐级恢复
+ *
+ * 解码线程在每个packet之前通过getFrameDiscard()取当前级别对应的AVCodecContext::skip_frame。
+ * seek后由解码线程调用reset()，级别立即恢复，渲染线程的计数在下一帧清零。
+ * */
+class LateFrameController {
+public:
+    enum class DecodeLevel { NORMAL, SKIP_NONREF, KEYFRAME_ONLY };
+
+    // 只在渲染线程调用。diff为视频pts - 主时钟(秒)，返回true表示这一帧应当丢弃
+    bool onFrame(double diff, double frameDuration, bool hasNextFrame) {
+        if (resetRequested.exchange(false, std::memory_order_acquire)) {
+            lateFrames = 0;
+            onTimeFrames = 0;
+            consecutiveDrops = 0;
+        }
+
+        const double lateness = -diff;
+        const double threshold = std::max(frameDuration, MIN_DROP_LATENESS);
+        DecodeLevel current = level.load(std::memory_order_relaxed);
+
+        if (lateness > threshold) {
+            lateFrames++;
+            onTimeFrames = 0;
+            if (lateness > KEYFRAME_LATENESS) {
+                setLevel(DecodeLevel::KEYFRAME_ONLY, lateness);
+            } else if (lateFrames >= ESCALATE_FRAMES && current != DecodeLevel::KEYFRAME_ONLY) {
+                setLevel(static_cast<DecodeLevel>(static_cast<int>(current) + 1), lateness);
+                lateFrames = 0;
+            }
+        } else {
+            lateFrames = 0;
+            onTimeFrames++;
+            // 只解码关键帧时帧很稀疏，赶上之后尽快恢复到跳过非参考帧
+            const int recoverFrames = current == DecodeLevel::KEYFRAME_ONLY ? 2 : RECOVER_FRAMES;
+            if (current != DecodeLevel::NORMAL && onTimeFrames >= recoverFrames) {
+                setLevel(static_cast<DecodeLevel>(static_cast<int>(current) - 1), lateness);
+                onTimeFrames = 0;
+            }
+        }
+
+        if (lateness > threshold && hasNextFrame && consecutiveDrops < MAX_CONSECUTIVE_DROPS) {
+            consecutiveDrops++;
+            return true;
+        }
+        consecutiveDrops = 0;
+        return false;
+    }
+
+    DecodeLevel getDecodeLevel() const {
+        return level.load(std::memory_order_relaxed);
+    }
+
+    AVDiscard getFrameDiscard() const {
+        switch (getDecodeLevel()) {
+            case DecodeLevel::SKIP_NONREF:
+                return AVDISCARD_NONREF;
+            case DecodeLevel::KEYFRAME_ONLY:
+                return AVDISCARD_NONKEY;
+            default:
+                return AVDISCARD_DEFAULT;
+        }
+    }
+
+    // seek或切换文件后调用，可以在任意线程
+    void reset() {
+        level.store(DecodeLevel::NORMAL, std::memory_order_relaxed);
+        resetRequested.store(true, std::memory_order_release);
+    }
+
+private:
+    static constexpr double MIN_DROP_LATENESS = 0.04;
+    static constexpr double KEYFRAME_LATENESS = 1.0;
+    static constexpr int ESCALATE_FRAMES = 5;
+    static constexpr int RECOVER_FRAMES = 30;
+    static constexpr int MAX_CONSECUTIVE_DROPS = 8;
+
+    std::atomic<DecodeLevel> level{DecodeLevel::NORMAL};
+    std::atomic<bool> resetRequested{false};
+
+    // 只在渲染线程访问
+    int lateFrames{0};
+    int onTimeFrames{0};
+    int consecutiveDrops{0};
+
+    void setLevel(DecodeLevel newLevel, double lateness) {
+        if (newLevel == level.load(std::memory_order_relaxed)) return;
+        static const char* names[] = {"normal", "skip non-ref", "keyframe only"};
+        LOGI_TAG("LateFrameController", "decode level %s -> %s, video is %.3fS late",
+                 names[static_cast<int>(level.load(std::memory_order_relaxed))],
+                 names[static_cast<int>(newLevel)], lateness);
+        level.store(newLevel, std::memory_order_relaxed);
+    }
+};
+
+#endif //GLMEDIAKIT_LATEFRAMECONTROLLER_HPP
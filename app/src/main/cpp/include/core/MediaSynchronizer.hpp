@@ -6,48 +6,175 @@
 #define GLMEDIAKIT_MEDIASYNCHRONIZER_HPP
 
 #include "core/IClock.h"
+#include "core/SeqlockClock.hpp"
+#include "platform/Log.h"
 
-#include <mutex>
+#include <algorithm>
+#include <atomic>
 
+/**
+ * 音频、视频和外部时钟，以及当前的主时钟
+ *
+ * 音频时钟由OpenSL ES回调线程更新，视频时钟由渲染线程更新，seek时Player线程reset。
+ * 外部时钟没有数据源更新，只在reset/暂停恢复时重新定位，之后按单调时钟走动。
+ * 每个时钟通过SeqlockClock发布，更新不会阻塞回调线程，读取总能拿到一致的pts/lastUpdateTime。
+ * 两次更新之间时钟按播放速度外推。
+ *
+ * 主时钟按媒体的轨道选择(selectMaster): 有音频输出时为音频，否则为外部时钟；
+ * 没有声音的预览(拖动进度条)期间使用视频时钟，画面按帧自身的间隔推进。
+ * 播放中切换主时钟时，新旧时钟之间的差值在SWITCH_SLEW_TIME内逐渐消除，主时钟不跳变。
+ * */
 class MediaSynchronizer {
 public:
     enum class SyncSource { AUDIO, VIDEO, EXTERNAL };
 
+    // 主时钟切换后与旧时钟的差值在这段时间(秒)内线性消除
+    static constexpr double SWITCH_SLEW_TIME = 0.5;
+
     explicit MediaSynchronizer(SyncSource master = SyncSource::AUDIO) :
         currentMaster(master)
     {
-        
+
     }
 
-    void update(const IClock& clock, SyncSource type) {
-        switch (type) {
+    static SyncSource selectMaster(bool hasAudioOutput) {
+        return hasAudioOutput ? SyncSource::AUDIO : SyncSource::EXTERNAL;
+    }
+
+    static const char* getSourceName(SyncSource source) {
+        switch (source) {
             case SyncSource::AUDIO:
-                return audioClock.update(clock);
+                return "audio";
             case SyncSource::VIDEO:
-                return videoClock.update(clock);
+                return "video";
             case SyncSource::EXTERNAL:
-                return externalClock.update(clock);
+                return "external";
         }
+        return "unknown";
     }
 
-    double getCurrentTime() {
-        switch (currentMaster) {
+    void update(const IClock& clock, SyncSource type) {
+        switch (type) {
             case SyncSource::AUDIO:
-                return audioClock.getCurrentTime();
+                return audioClock.store(clock);
             case SyncSource::VIDEO:
-                return videoClock.getCurrentTime();
+                return videoClock.store(clock);
             case SyncSource::EXTERNAL:
-                return externalClock.getCurrentTime();
+                return externalClock.store(clock);
+        }
+    }
+
+    double getCurrentTime() const {
+        if (paused.load(std::memory_order_acquire)) {
+            return pausedTime.load(std::memory_order_relaxed);
+        }
+
+        // 切换主时钟后剩余的差值，pts为切换时的差值，lastUpdateTime为切换时刻
+        IClock switchOffset = transition.load();
+        double offset = 0;
+        if (switchOffset.pts != 0) {
+            double elapsed = av_gettime_relative() / 1000000.0 - switchOffset.lastUpdateTime;
+            offset = switchOffset.pts * std::max(0.0, 1.0 - elapsed / SWITCH_SLEW_TIME);
+        }
+        return getClock(currentMaster.load(std::memory_order_relaxed)) + offset;
+    }
+
+    SyncSource getMaster() const { return currentMaster.load(std::memory_order_relaxed); }
+
+    // 播放中切换主时钟，可以在任意线程调用。并发切换时由compare_exchange决定哪一次生效，
+    // 之后才发布切换差值，读取方最多在这两步之间看到一次不带差值的新主时钟
+    void setMaster(SyncSource master) {
+        SyncSource old = currentMaster.load(std::memory_order_acquire);
+        double now = 0;
+        double current = 0;
+        do {
+            if (old == master) return;
+            now = av_gettime_relative() / 1000000.0;
+            current = getCurrentTime();
+            if (master == SyncSource::EXTERNAL) {
+                // 外部时钟没有自己的数据源，直接从当前位置接着走
+                externalClock.store(IClock{current, now});
+            }
+        } while (!currentMaster.compare_exchange_weak(old, master, std::memory_order_acq_rel));
+
+        const double offset = current - getClock(master);
+        transition.store(IClock{offset, now});
+        LOGI_TAG("MediaSynchronizer", "master clock %s -> %s at %.3fS, offset %.3fS",
+                 getSourceName(old), getSourceName(master), current, offset);
+    }
+
+    // 修改播放速度: 先按旧速度把各时钟推进到当前时刻，之后按新速度外推，切换时时钟不跳变
+    void setPlaybackRate(double rate) {
+        const double oldRate = playbackRate.load(std::memory_order_relaxed);
+        IClock clock;
+        clock.lastUpdateTime = av_gettime_relative() / 1000000.0;
+        for (SeqlockClock* c : {&audioClock, &videoClock, &externalClock}) {
+            clock.pts = c->getCurrentTime(oldRate);
+            c->store(clock);
         }
+        playbackRate.store(rate, std::memory_order_relaxed);
     }
+    double getPlaybackRate() const { return playbackRate.load(std::memory_order_relaxed); }
+
+    // 暂停期间主时钟停在暂停时的位置
+    void pause() {
+        if (paused.load(std::memory_order_relaxed)) return;
+        pausedTime.store(getCurrentTime(), std::memory_order_relaxed);
+        paused.store(true, std::memory_order_release);
+    }
+
+    // 所有时钟从暂停的位置重新开始走，音频时钟在下一次输出时更新为实际播放位置
+    void resume() {
+        if (!paused.load(std::memory_order_relaxed)) return;
+        reanchor(pausedTime.load(std::memory_order_relaxed));
+        paused.store(false, std::memory_order_release);
+    }
+
+    // seek后所有时钟都从目标位置开始走，避免新数据到来之前仍以旧位置做同步
+    void reset(double pts) {
+        pausedTime.store(pts, std::memory_order_relaxed);
+        reanchor(pts);
+    }
+
+    // 当前播放数据的序号，每次seek加一。帧的序号小于该值说明是seek之前的旧数据，消费者直接丢弃
+    void setSerial(int s) { serial.store(s, std::memory_order_release); }
+    int getSerial() const { return serial.load(std::memory_order_acquire); }
 
 private:
-    IClock audioClock;
-    IClock videoClock;
-    IClock externalClock;
+    SeqlockClock audioClock;
+    SeqlockClock videoClock;
+    SeqlockClock externalClock;
+    // 主时钟切换时的差值
+    SeqlockClock transition;
 
-    std::mutex clockMtx;
-    SyncSource currentMaster;
+    std::atomic<SyncSource> currentMaster;
+    std::atomic<double> playbackRate{1.0};
+    std::atomic<int> serial{0};
+    std::atomic<bool> paused{false};
+    std::atomic<double> pausedTime{0};
+
+    double getClock(SyncSource source) const {
+        const double speed = playbackRate.load(std::memory_order_relaxed);
+        switch (source) {
+            case SyncSource::AUDIO:
+                return audioClock.getCurrentTime(speed);
+            case SyncSource::VIDEO:
+                return videoClock.getCurrentTime(speed);
+            case SyncSource::EXTERNAL:
+                return externalClock.getCurrentTime(speed);
+        }
+        return 0;
+    }
+
+    void reanchor(double pts) {
+        IClock clock;
+        clock.pts = pts;
+        clock.lastUpdateTime = av_gettime_relative() / 1000000.0;
+        for (SeqlockClock* c : {&audioClock, &videoClock, &externalClock}) {
+            c->store(clock);
+        }
+        transition.store(IClock{});
+    }
 };
 
 #endif //GLMEDIAKIT_MEDIASYNCHRONIZER_HPP
@@ -0,0 +1,90 @@
+//
+// Created by Weichuandong on 2025/5/5.
+//
+
+#ifndef GLMEDIAKIT_PACKETPOOL_HPP
+#define GLMEDIAKIT_PACKETPOOL_HPP
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+};
+
+/**
+ * 有界的AVPacket壳对象池，与FramePool对应
+ *
+ * 解封装线程acquire()取一个空的AVPacket交给av_read_frame填充，解码线程用完(或队列flush时)release()，
+ * 包数据的引用被释放，AVPacket本身回到池中。池为空时才分配新的AVPacket，池满时多余的直接释放，
+ * 稳定播放时解封装不再有逐包的AVPacket分配。
+ * */
+class PacketPool {
+public:
+    explicit PacketPool(size_t capacity = 64) :
+        capacity(capacity)
+    {
+        freePackets.reserve(capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            AVPacket* packet = av_packet_alloc();
+            if (packet) freePackets.push_back(packet);
+        }
+    }
+
+    ~PacketPool() {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (AVPacket* packet : freePackets) {
+            av_packet_free(&packet);
+        }
+        freePackets.clear();
+    }
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    // 获取一个不引用任何数据的AVPacket
+    AVPacket* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!freePackets.empty()) {
+                AVPacket* packet = freePackets.back();
+                freePackets.pop_back();
+                hitCount.fetch_add(1, std::memory_order_relaxed);
+                return packet;
+            }
+        }
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return av_packet_alloc();
+    }
+
+    // 归还AVPacket，同时释放其引用的包数据
+    void release(AVPacket* packet) {
+        if (!packet) return;
+        av_packet_unref(packet);
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (freePackets.size() < capacity) {
+                freePackets.push_back(packet);
+                return;
+            }
+        }
+        av_packet_free(&packet);
+    }
+
+    uint64_t getHitCount() const { return hitCount.load(std::memory_order_relaxed); }
+    uint64_t getMissCount() const { return missCount.load(std::memory_order_relaxed); }
+
+private:
+    const size_t capacity;
+    std::vector<AVPacket*> freePackets;
+    std::mutex mtx;
+
+    std::atomic<uint64_t> hitCount{0};
+    std::atomic<uint64_t> missCount{0};
+};
+
+#endif //GLMEDIAKIT_PACKETPOOL_HPP
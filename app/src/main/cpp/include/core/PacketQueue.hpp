@@ -0,0 +1,207 @@
+//
+// Created by Weichuandong on 2025/4/18.
+//
+
+#ifndef GLMEDIAKIT_PACKETQUEUE_HPP
+#define GLMEDIAKIT_PACKETQUEUE_HPP
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+};
+
+#include "core/Trace.hpp"
+#include "core/PacketPool.hpp"
+
+// 包队列的缓冲水位
+struct BufferLevel {
+    int packets{0};
+    int64_t bytes{0};       // 包数据加上AVPacket结构体本身
+    double duration{0};     // 已缓冲的时长(秒)，由各packet的duration累加
+};
+
+/**
+ * 解封装线程 -> 解码线程的packet队列，按字节数和缓冲时长统计水位
+ *
+ * push不会阻塞：是否继续读取由解封装线程根据两个队列的水位统一决定(见FFmpegReader::isBufferFull)，
+ * 避免一个队列满了把解封装线程卡住，导致另一个流的解码线程没有数据。
+ * pop/flush/pause/resume与SafeQueue的行为一致，nullptr表示流结束。
+ * 每个packet入队时带上当前序号(seek一次加一)，解码线程发现序号变化时先flush解码器。
+ * 设置了packetPool时，flush和切换序号丢弃的packet归还到池中，否则直接释放。
+ * */
+class PacketQueue {
+public:
+    explicit PacketQueue(std::shared_ptr<PacketPool> packetPool = nullptr,
+                         AVRational timeBase = AVRational{1, AV_TIME_BASE}) :
+        packetPool(std::move(packetPool)),
+        timeBase(timeBase) {}
+
+    ~PacketQueue() {
+        flush();    //释放资源
+    }
+
+    PacketQueue(const PacketQueue&) = delete;
+    PacketQueue& operator=(const PacketQueue&) = delete;
+
+    // 时长统计使用的时间基，open之后由读取方设置
+    void setTimeBase(AVRational tb) {
+        std::lock_guard<std::mutex> lock(mtx);
+        timeBase = tb;
+    }
+
+    // seek后调用: 丢弃旧序号的packet，之后入队的packet都带上新序号
+    void setSerial(int newSerial) {
+        std::lock_guard<std::mutex> lock(mtx);
+        clear();
+        serial = newSerial;
+    }
+
+    int getSerial() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return serial;
+    }
+
+    bool push(AVPacket* packet) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (flushing) return false;
+
+        queue.push_back({packet, serial});
+        if (packet) {
+            level.packets++;
+            level.bytes += packet->size + (int64_t)sizeof(AVPacket);
+            durationTicks += packet->duration > 0 ? packet->duration : 0;
+        }
+        updateDuration();
+        dataCond.notify_one();
+        return true;
+    }
+
+    bool pop(AVPacket*& packet, int& packetSerial, int timeoutMs = -1) {
+        std::unique_lock<std::mutex> lock(mtx);
+
+        auto pred = [this]() { return !queue.empty() || flushing || isPaused; };
+        if (!pred()) {
+            TRACE_SCOPE("packet_queue_pop_wait");
+            if (timeoutMs > 0) {
+                if (!dataCond.wait_for(lock, std::chrono::milliseconds(timeoutMs), pred)) {
+                    return false;
+                }
+            } else {
+                dataCond.wait(lock, pred);
+            }
+        }
+
+        if (queue.empty() || flushing) return false;
+
+        packet = queue.front().packet;
+        packetSerial = queue.front().serial;
+        queue.pop_front();
+        if (packet) {
+            level.packets--;
+            level.bytes -= packet->size + (int64_t)sizeof(AVPacket);
+            durationTicks -= packet->duration > 0 ? packet->duration : 0;
+        }
+        updateDuration();
+        return true;
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(mtx);
+        flushing = true;
+        clear();
+        dataCond.notify_all();
+    }
+
+    void resume() {
+        std::lock_guard<std::mutex> lock(mtx);
+        isPaused = false;
+        flushing = false;
+        dataCond.notify_all();
+    }
+
+    void pause() {
+        std::lock_guard<std::mutex> lock(mtx);
+        isPaused = true;
+        dataCond.notify_all();
+    }
+
+    int getSize() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return (int)queue.size();
+    }
+
+    BufferLevel getLevel() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return level;
+    }
+
+    // 解封装线程每读一个包都要判断水位，这几个值不加锁读取
+    int64_t getBytes() const { return atomicBytes.load(std::memory_order_relaxed); }
+    double getDuration() const { return atomicDuration.load(std::memory_order_relaxed); }
+    int getPackets() const { return atomicPackets.load(std::memory_order_relaxed); }
+
+    // 不加锁的水位，各项分别读取，用于统计采样
+    BufferLevel peekLevel() const {
+        BufferLevel peek;
+        peek.packets = getPackets();
+        peek.bytes = getBytes();
+        peek.duration = getDuration();
+        return peek;
+    }
+
+private:
+    struct Entry {
+        AVPacket* packet;
+        int serial;
+    };
+
+    std::shared_ptr<PacketPool> packetPool;
+    std::deque<Entry> queue;
+    std::mutex mtx;
+    std::condition_variable dataCond;
+    bool flushing{false};
+    std::atomic<bool> isPaused{false};
+    int serial{0};
+
+    AVRational timeBase;
+    int64_t durationTicks{0};
+    BufferLevel level;
+    std::atomic<int64_t> atomicBytes{0};
+    std::atomic<double> atomicDuration{0};
+    std::atomic<int> atomicPackets{0};
+
+    // 需持有mtx
+    void clear() {
+        for (Entry& entry : queue) {
+            if (!entry.packet) continue;
+            if (packetPool) {
+                packetPool->release(entry.packet);
+            } else {
+                av_packet_free(&entry.packet);
+            }
+        }
+        queue.clear();
+        level = BufferLevel();
+        durationTicks = 0;
+        atomicDuration = 0;
+        atomicBytes = 0;
+        atomicPackets = 0;
+    }
+
+    // 需持有mtx
+    void updateDuration() {
+        level.duration = timeBase.den > 0 ? durationTicks * av_q2d(timeBase) : 0;
+        atomicDuration.store(level.duration, std::memory_order_relaxed);
+        atomicBytes.store(level.bytes, std::memory_order_relaxed);
+        atomicPackets.store(level.packets, std::memory_order_relaxed);
+    }
+};
+
+#endif //GLMEDIAKIT_PACKETQUEUE_HPP
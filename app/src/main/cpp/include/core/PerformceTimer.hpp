@@ -8,9 +8,7 @@
 #include <chrono>
 #include <string>
 #include <utility>
-#include <android/log.h>
-
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, "PerformanceTimer", __VA_ARGS__)
+#include "platform/Log.h"
 
 class PerformanceTimer {
 private:
@@ -36,7 +34,7 @@ public:
         auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>
                 (now - startTime).count();
-        LOGI("性能[%s]: %s - %lld ms", operationName.c_str(),
+        LOGI_TAG("PerformanceTimer", "性能[%s]: %s - %lld ms", operationName.c_str(),
              checkpoint.c_str(), (long long)elapsed);
     }
 };
@@ -0,0 +1,198 @@
+//
+// Created by Weichuandong on 2025/4/23.
+//
+
+#ifndef GLMEDIAKIT_PLAYBACKSTATS_HPP
+#define GLMEDIAKIT_PLAYBACKSTATS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * 无锁的耗时直方图，单位微秒
+ *
+ * 桶按对数-线性划分: 0~15us每微秒一个桶，之后每个2的幂区间再均分为16个桶，
+ * 相对误差约6%，覆盖到2^31us(约35分钟)。record()只有两三次relaxed原子操作，
+ * 可以在解码/渲染的热路径上调用；读取百分位时直接扫描桶，读到的是近似一致的快照。
+ * */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 31;
+    static constexpr int BUCKET_COUNT = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void record(int64_t valueUs) {
+        if (valueUs < 0) valueUs = 0;
+        buckets[bucketIndex((uint64_t)valueUs)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+
+        int64_t prev = maxUs.load(std::memory_order_relaxed);
+        while (valueUs > prev &&
+               !maxUs.compare_exchange_weak(prev, valueUs, std::memory_order_relaxed)) {
+        }
+    }
+
+    // percentile取值(0, 1]，返回所在桶的中间值(微秒)，没有样本时返回0
+    int64_t percentile(double percentile) const {
+        uint64_t total = count.load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+
+        uint64_t target = (uint64_t)(percentile * total + 0.5);
+        if (target < 1) target = 1;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                int64_t value = bucketMidpoint(i);
+                int64_t max = getMax();
+                return value < max ? value : max;
+            }
+        }
+        return getMax();
+    }
+
+    uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+    int64_t getMax() const { return maxUs.load(std::memory_order_relaxed); }
+
+    // 与record()并发调用时可能残留少量样本，只在切换文件时使用
+    void reset() {
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count.store(0, std::memory_order_relaxed);
+        maxUs.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> buckets[BUCKET_COUNT]{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<int64_t> maxUs{0};
+
+    static int bucketIndex(uint64_t value) {
+        if (value < SUB_BUCKETS) return (int)value;
+        int exponent = 63 - __builtin_clzll(value);
+        if (exponent > MAX_EXPONENT) return BUCKET_COUNT - 1;
+        int sub = (int)((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+        return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub;
+    }
+
+    static int64_t bucketMidpoint(int index) {
+        if (index < SUB_BUCKETS) return index;
+        int exponent = (index - SUB_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS;
+        int sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        int64_t width = (int64_t)1 << (exponent - SUB_BUCKET_BITS);
+        int64_t lower = ((int64_t)1 << exponent) + sub * width;
+        return lower + width / 2;
+    }
+};
+
+/**
+ * 播放过程中的运行时统计，由各线程在热路径上无锁累加，Player::getStats()读取快照
+ *
+ * - 解封装线程: 读取的字节数
+ * - 解码线程: 解码帧数、视频每个packet的解码耗时(SendPacket + ReceiveFrame，不含入队等待)
+ * - 渲染线程: 渲染帧数、丢弃帧数(seek前的旧帧/落后太多的帧)、音视频偏差、每帧onDrawFrame(纹理上传和绘制提交)耗时
+ * */
+class PlaybackStats {
+public:
+    struct Percentiles {
+        double p50Ms{0};
+        double p90Ms{0};
+        double p99Ms{0};
+        double maxMs{0};
+    };
+
+    // 对外的快照，队列深度由Player在读取时补充
+    struct Snapshot {
+        int videoPacketQueuePackets{0};
+        int64_t videoPacketQueueBytes{0};
+        int audioPacketQueuePackets{0};
+        int64_t audioPacketQueueBytes{0};
+        int videoFrameQueueSize{0};
+        int audioFrameQueueSize{0};
+
+        uint64_t videoFramesDecoded{0};
+        uint64_t audioFramesDecoded{0};
+        uint64_t videoFramesRendered{0};
+        uint64_t videoFramesDropped{0};
+        uint64_t videoFramesDroppedLate{0};
+        uint64_t bytesRead{0};
+        int videoDecodeLevel{0};        // LateFrameController::DecodeLevel，由Player补充
+
+        double lastAvDriftMs{0};        // 最近一帧视频pts - 主时钟，正值表示视频超前
+        Percentiles avDrift;            // 偏差的绝对值
+        Percentiles videoDecodeTime;
+        Percentiles uploadTime;
+    };
+
+    static Percentiles toPercentiles(const LatencyHistogram& histogram) {
+        Percentiles p;
+        p.p50Ms = histogram.percentile(0.50) / 1000.0;
+        p.p90Ms = histogram.percentile(0.90) / 1000.0;
+        p.p99Ms = histogram.percentile(0.99) / 1000.0;
+        p.maxMs = histogram.getMax() / 1000.0;
+        return p;
+    }
+
+    void addBytesRead(int64_t bytes) { bytesRead.fetch_add((uint64_t)bytes, std::memory_order_relaxed); }
+    void onVideoFrameDecoded() { videoFramesDecoded.fetch_add(1, std::memory_order_relaxed); }
+    void onAudioFrameDecoded() { audioFramesDecoded.fetch_add(1, std::memory_order_relaxed); }
+    void onVideoFrameRendered() { videoFramesRendered.fetch_add(1, std::memory_order_relaxed); }
+    void onVideoFrameDropped() { videoFramesDropped.fetch_add(1, std::memory_order_relaxed); }
+    void onVideoFrameDroppedLate() { videoFramesDroppedLate.fetch_add(1, std::memory_order_relaxed); }
+
+    void recordAvDrift(double diffSeconds) {
+        int64_t diffUs = (int64_t)(diffSeconds * 1000000);
+        lastAvDriftUs.store(diffUs, std::memory_order_relaxed);
+        avDrift.record(diffUs < 0 ? -diffUs : diffUs);
+    }
+    void recordVideoDecodeTime(int64_t us) { videoDecodeTime.record(us); }
+    void recordUploadTime(int64_t us) { uploadTime.record(us); }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.videoFramesDecoded = videoFramesDecoded.load(std::memory_order_relaxed);
+        s.audioFramesDecoded = audioFramesDecoded.load(std::memory_order_relaxed);
+        s.videoFramesRendered = videoFramesRendered.load(std::memory_order_relaxed);
+        s.videoFramesDropped = videoFramesDropped.load(std::memory_order_relaxed);
+        s.videoFramesDroppedLate = videoFramesDroppedLate.load(std::memory_order_relaxed);
+        s.bytesRead = bytesRead.load(std::memory_order_relaxed);
+        s.lastAvDriftMs = lastAvDriftUs.load(std::memory_order_relaxed) / 1000.0;
+        s.avDrift = toPercentiles(avDrift);
+        s.videoDecodeTime = toPercentiles(videoDecodeTime);
+        s.uploadTime = toPercentiles(uploadTime);
+        return s;
+    }
+
+    void reset() {
+        videoFramesDecoded.store(0, std::memory_order_relaxed);
+        audioFramesDecoded.store(0, std::memory_order_relaxed);
+        videoFramesRendered.store(0, std::memory_order_relaxed);
+        videoFramesDropped.store(0, std::memory_order_relaxed);
+        videoFramesDroppedLate.store(0, std::memory_order_relaxed);
+        bytesRead.store(0, std::memory_order_relaxed);
+        lastAvDriftUs.store(0, std::memory_order_relaxed);
+        avDrift.reset();
+        videoDecodeTime.reset();
+        uploadTime.reset();
+    }
+
+private:
+    // 不同线程写入的计数器分开缓存行，避免伪共享
+    alignas(64) std::atomic<uint64_t> bytesRead{0};
+    alignas(64) std::atomic<uint64_t> videoFramesDecoded{0};
+    alignas(64) std::atomic<uint64_t> audioFramesDecoded{0};
+    alignas(64) std::atomic<uint64_t> videoFramesRendered{0};
+    std::atomic<uint64_t> videoFramesDropped{0};
+    std::atomic<uint64_t> videoFramesDroppedLate{0};
+    std::atomic<int64_t> lastAvDriftUs{0};
+
+    alignas(64) LatencyHistogram avDrift;
+    alignas(64) LatencyHistogram videoDecodeTime;
+    alignas(64) LatencyHistogram uploadTime;
+};
+
+#endif //GLMEDIAKIT_PLAYBACKSTATS_HPP
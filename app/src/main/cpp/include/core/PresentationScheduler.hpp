@@ -0,0 +1,177 @@
+//
+// Created by Weichuandong on 2025/4/29.
+//
+
+#ifndef GLMEDIAKIT_PRESENTATIONSCHEDULER_HPP
+#define GLMEDIAKIT_PRESENTATIONSCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include "core/Trace.hpp"
+
+/**
+ * 视频帧的显示调度
+ *
+ * 渲染线程每取出一帧调用schedule()，同时给出队列中下一帧的pts(向前看一帧):
+ * - target:   主时钟走到该帧pts的时刻
+ * - vsync:    离target最近的vsync，即该帧应当出现在屏幕上的时刻。上一帧已经占用的vsync顺延一个周期
+ * - deadline: 开始上传纹理并提交的时刻，取vsync之前半个刷新周期，留出绘制时间又不会被更早的vsync取走
+ * 下一帧会落在同一个vsync上时(帧率高于刷新率或快速播放)，这一帧永远不会被看到，直接丢弃。
+ *
+ * vsync时钟: 有真实vsync(Choreographer)时通过onVsync()校准相位，否则以第一帧的target为相位按刷新周期模拟。
+ * waitUntil()先用系统睡眠等到deadline前SPIN_THRESHOLD_US，剩余部分让出CPU自旋，唤醒误差在亚毫秒级。
+ *
+ * 时间(微秒)都来自TimeSource，默认为CLOCK_MONOTONIC(与av_gettime_relative()同一时间基)，
+ * 测试时替换为假时钟，配合合成的帧序列验证调度结果(见benchmark/SchedulerBenchmark.cpp)。
+ * schedule()/waitUntil()/reset()只在渲染线程调用，setRefreshRate()/onVsync()可以在任意线程调用。
+ * */
+class PresentationScheduler {
+public:
+    class TimeSource {
+    public:
+        virtual ~TimeSource() = default;
+        virtual int64_t now() = 0;
+        // us <= 0时只让出CPU
+        virtual void sleepFor(int64_t us) = 0;
+    };
+
+    class SystemTimeSource : public TimeSource {
+    public:
+        int64_t now() override {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void sleepFor(int64_t us) override {
+            if (us <= 0) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(us));
+            }
+        }
+    };
+
+    enum class Action { PRESENT, DROP };
+
+    struct Decision {
+        Action action{Action::PRESENT};
+        int64_t targetUs{0};
+        int64_t vsyncUs{0};
+        int64_t deadlineUs{0};
+    };
+
+    // 距离deadline小于该值时不再交给系统睡眠
+    static constexpr int64_t SPIN_THRESHOLD_US = 1000;
+    // 单次系统睡眠的上限，等待期间可以及时响应暂停、退出和seek
+    static constexpr int64_t MAX_SLEEP_US = 10000;
+    // 最多提前等待的时间，主时钟不走(音频还没有开始输出)时画面仍然会更新
+    static constexpr int64_t MAX_WAIT_US = 100000;
+
+    explicit PresentationScheduler(std::shared_ptr<TimeSource> source = std::make_shared<SystemTimeSource>()) :
+        timeSource(std::move(source))
+    {
+
+    }
+
+    int64_t now() { return timeSource->now(); }
+
+    // 由Java层Display.getRefreshRate()设置，默认60Hz
+    void setRefreshRate(double hz) {
+        if (hz <= 0) return;
+        refreshIntervalUs.store((int64_t)(1000000.0 / hz), std::memory_order_relaxed);
+    }
+
+    int64_t getRefreshIntervalUs() const {
+        return refreshIntervalUs.load(std::memory_order_relaxed);
+    }
+
+    // 真实vsync的时间戳，用于校准模拟vsync的相位
+    void onVsync(int64_t timestampUs) {
+        vsyncPhaseUs.store(timestampUs, std::memory_order_relaxed);
+    }
+
+    // seek、暂停、变速等时间线不连续之后调用，之前的帧不再占用vsync
+    void reset() {
+        lastVsyncUs = NO_TIME;
+    }
+
+    // masterTime为masterSampleUs时刻读到的主时钟(秒)，nextPts为NAN表示队列中还没有下一帧
+    Decision schedule(double pts, double nextPts, double masterTime, int64_t masterSampleUs, double rate) {
+        const int64_t refreshUs = refreshIntervalUs.load(std::memory_order_relaxed);
+        int64_t phase = vsyncPhaseUs.load(std::memory_order_relaxed);
+
+        Decision d;
+        d.targetUs = masterSampleUs + std::llround((pts - masterTime) / rate * 1000000);
+        if (phase == NO_TIME) {
+            phase = d.targetUs;
+            vsyncPhaseUs.store(phase, std::memory_order_relaxed);
+        }
+
+        d.vsyncUs = alignToVsync(d.targetUs, phase, refreshUs);
+        if (lastVsyncUs != NO_TIME && d.vsyncUs <= lastVsyncUs) {
+            d.vsyncUs = lastVsyncUs + refreshUs;
+        }
+
+        if (!std::isnan(nextPts) && nextPts > pts) {
+            const int64_t nextTargetUs = d.targetUs + std::llround((nextPts - pts) / rate * 1000000);
+            if (alignToVsync(nextTargetUs, phase, refreshUs) <= d.vsyncUs) {
+                d.action = Action::DROP;
+                return d;
+            }
+        }
+
+        d.deadlineUs = d.vsyncUs - refreshUs / 2;
+        lastVsyncUs = d.vsyncUs;
+        if (d.deadlineUs > masterSampleUs + MAX_WAIT_US) {
+            // 提前显示，不占用原来的vsync
+            d.deadlineUs = masterSampleUs + MAX_WAIT_US;
+            lastVsyncUs = NO_TIME;
+        }
+        return d;
+    }
+
+    // 等到deadlineUs，interrupted()返回true时提前返回false
+    template<typename Interrupted>
+    bool waitUntil(int64_t deadlineUs, Interrupted&& interrupted) {
+        for (;;) {
+            if (interrupted()) return false;
+            const int64_t remaining = deadlineUs - timeSource->now();
+            if (remaining <= 0) {
+                TRACE_COUNTER("present_wake_error_us", -remaining);
+                return true;
+            }
+            if (remaining > SPIN_THRESHOLD_US) {
+                timeSource->sleepFor(std::min(remaining - SPIN_THRESHOLD_US, MAX_SLEEP_US));
+            } else {
+                timeSource->sleepFor(0);
+            }
+        }
+    }
+
+private:
+    static constexpr int64_t NO_TIME = std::numeric_limits<int64_t>::min();
+
+    std::shared_ptr<TimeSource> timeSource;
+    std::atomic<int64_t> refreshIntervalUs{16667};
+    std::atomic<int64_t> vsyncPhaseUs{NO_TIME};
+
+    // 只在渲染线程访问
+    int64_t lastVsyncUs{NO_TIME};
+
+    // 离t最近的vsync
+    static int64_t alignToVsync(int64_t t, int64_t phase, int64_t refreshUs) {
+        const int64_t offset = t - phase + refreshUs / 2;
+        int64_t n = offset / refreshUs;
+        if (offset % refreshUs < 0) --n;
+        return phase + n * refreshUs;
+    }
+};
+
+#endif //GLMEDIAKIT_PRESENTATIONSCHEDULER_HPP
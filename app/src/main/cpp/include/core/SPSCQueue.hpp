@@ -0,0 +1,295 @@
+//
+// Created by Weichuandong on 2025/4/15.
+//
+
+#ifndef GLMEDIAKIT_SPSCQUEUE_HPP
+#define GLMEDIAKIT_SPSCQUEUE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "core/Trace.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+};
+
+/**
+ * 单生产者单消费者的有界环形队列，接口与SafeQueue保持一致（push/pop/flush/pause/resume/getSize）
+ *
+ * - push只能在生产者线程调用，pop只能在消费者线程调用
+ * - 快路径上只有原子读写，不加锁；队列满(生产者)或空(消费者)时先让出CPU几次，仍然不满足才挂到条件变量上等待
+ * - 暂停时生产者可以超出队列大小继续push，实际容量用完后挂起直到resume/flush，push只在flush或超时时返回false
+ * - flush/pause/resume/getSize可以在任意线程调用
+ * - flush记录当前写位置，之前的元素由消费者(或flush调用方)释放，不会与pop并发访问同一个槽位；
+ *   设置了recycler时交给recycler回收(例如还给FramePool)，否则直接释放
+ * - 队列大小可以在运行时通过setMaxSize调整，上限是构造时给出的maxCapacity
+ * */
+template<typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(size_t maxSize = 3, size_t maxCapacity = 0) :
+        maxSize(maxSize > 0 ? maxSize : 1)
+    {
+        // 实际容量取2倍并向上对齐到2的幂，多出的部分留给暂停状态下的生产者，与SafeQueue暂停时可以超出队列大小的行为一致
+        size_t limit = std::max(this->maxSize.load(), maxCapacity);
+        size_t capacity = 2;
+        while (capacity < limit * 2) capacity <<= 1;
+        buffer.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    ~SPSCQueue() {
+        drainTo.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+        discardStale();    //释放资源
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // 生产者线程调用
+    bool push(const T& item, int timeoutMs = -1) {
+        if (flushing.load(std::memory_order_acquire)) return false;
+
+        const size_t t = tail.load(std::memory_order_relaxed);
+        for (int i = 0; i < SPIN_COUNT && !hasSpace(t) && !isPaused && !flushing; ++i) {
+            std::this_thread::yield();
+        }
+        // 暂停状态下可以超出队列大小，与SafeQueue一致；实际容量也用完时同样挂起等待，不丢弃元素
+        if (!hasSpace(t) && !(isPaused.load(std::memory_order_acquire) && hasCapacity(t))) {
+            TRACE_SCOPE("frame_queue_push_wait");
+            std::unique_lock<std::mutex> lock(parkMtx);
+            producerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            auto pred = [this, t]() { return flushing || hasSpace(t) || (isPaused && hasCapacity(t)); };
+            bool ok = true;
+            if (timeoutMs > 0) {
+                ok = spaceCond.wait_for(lock, std::chrono::milliseconds(timeoutMs), pred);
+            } else {
+                spaceCond.wait(lock, pred);
+            }
+            producerWaiting.store(false, std::memory_order_relaxed);
+            if (!ok || flushing) return false;
+        }
+
+        buffer[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(parkMtx);
+            dataCond.notify_one();
+        }
+        return true;
+    }
+
+    // 消费者线程调用
+    bool pop(T& item, int timeoutMs = -1) {
+        // flush正在释放旧数据，此次视为没有数据
+        if (consumerBusy.exchange(true, std::memory_order_acquire)) return false;
+        ConsumerGuard guard(consumerBusy);
+
+        discardStale();
+        size_t h = head.load(std::memory_order_relaxed);
+        for (int i = 0; i < SPIN_COUNT && h == tail.load(std::memory_order_acquire) && !isPaused && !flushing; ++i) {
+            std::this_thread::yield();
+        }
+        if (h == tail.load(std::memory_order_acquire)) {
+            if (flushing || isPaused) return false;
+
+            TRACE_SCOPE("frame_queue_pop_wait");
+            std::unique_lock<std::mutex> lock(parkMtx);
+            consumerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            auto pred = [this, h]() { return tail.load(std::memory_order_acquire) != h || flushing || isPaused; };
+            bool ok = true;
+            if (timeoutMs > 0) {
+                ok = dataCond.wait_for(lock, std::chrono::milliseconds(timeoutMs), pred);
+            } else {
+                dataCond.wait(lock, pred);
+            }
+            consumerWaiting.store(false, std::memory_order_relaxed);
+            lock.unlock();
+            if (!ok) return false;
+
+            discardStale();
+            h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) return false;
+        }
+
+        item = std::move(buffer[h & mask]);
+        buffer[h & mask] = T();
+        head.store(h + 1, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(parkMtx);
+            spaceCond.notify_one();
+        }
+        return true;
+    }
+
+    // 消费者线程调用，不等待。队首元素存在时以它调用visit并返回true，元素仍留在队列中。
+    // flush可能在visit返回后释放该元素，visit中只能读取需要的字段，不能保存元素本身
+    template<typename Visitor>
+    bool peek(Visitor&& visit) {
+        if (consumerBusy.exchange(true, std::memory_order_acquire)) return false;
+        ConsumerGuard guard(consumerBusy);
+
+        discardStale();
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+
+        visit(static_cast<const T&>(buffer[h & mask]));
+        return true;
+    }
+
+    void flush() {
+        flushing.store(true, std::memory_order_release);
+        drainTo.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+
+        // 消费者空闲时直接释放，否则交给消费者下一次pop时释放
+        if (!consumerBusy.exchange(true, std::memory_order_acquire)) {
+            discardStale();
+            consumerBusy.store(false, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> lock(parkMtx);
+        dataCond.notify_all();
+        spaceCond.notify_all();
+    }
+
+    void resume() {
+        std::lock_guard<std::mutex> lock(parkMtx);
+        isPaused = false;
+        flushing = false;
+        // 唤醒所有可能在等待的线程
+        dataCond.notify_all();
+        spaceCond.notify_all();
+    }
+
+    // 增加暂停能力，确保使用方不会阻塞在队列中
+    void pause() {
+        std::lock_guard<std::mutex> lock(parkMtx);
+        isPaused = true;
+        dataCond.notify_all();
+        spaceCond.notify_all();
+    }
+
+    // 被flush或析构丢弃的元素交给recycler，需要在生产者和消费者开始使用队列之前设置
+    void setRecycler(std::function<void(T)> recycler) {
+        this->recycler = std::move(recycler);
+    }
+
+    // 运行时调整队列大小，超出maxCapacity的部分会被截断，返回实际生效的大小
+    size_t setMaxSize(size_t size) {
+        size = std::min(std::max<size_t>(size, 1), (mask + 1) / 2);
+        size_t old = maxSize.exchange(size, std::memory_order_acq_rel);
+        // 变大时唤醒可能在等待空间的生产者；变小时已入队的元素不受影响，消费到新大小以下后才能继续push
+        if (size > old) {
+            std::lock_guard<std::mutex> lock(parkMtx);
+            spaceCond.notify_all();
+        }
+        return size;
+    }
+
+    size_t getMaxSize() const { return maxSize.load(std::memory_order_relaxed); }
+    size_t getMaxCapacity() const { return (mask + 1) / 2; }
+
+    // 无锁读取，结果是一个近似快照
+    int getSize() const {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t d = drainTo.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_acquire);
+        return static_cast<int>(t - std::max(h, d));
+    }
+
+private:
+    struct ConsumerGuard {
+        std::atomic<bool>& busy;
+        explicit ConsumerGuard(std::atomic<bool>& b) : busy(b) {}
+        ~ConsumerGuard() { busy.store(false, std::memory_order_release); }
+    };
+
+    // 挂起前先让出CPU若干次，短暂的空/满不必走条件变量
+    static constexpr int SPIN_COUNT = 16;
+
+    std::vector<T> buffer;
+    size_t mask{0};
+    std::atomic<size_t> maxSize;
+
+    // 读写位置分开放在不同缓存行，避免生产者与消费者伪共享
+    alignas(64) std::atomic<size_t> head{0};     // 只由消费者(或持有consumerBusy的flush)写
+    alignas(64) std::atomic<size_t> tail{0};     // 只由生产者写
+    alignas(64) std::atomic<size_t> drainTo{0};  // flush时的写位置，之前的元素都需要丢弃
+
+    std::atomic<bool> consumerBusy{false};
+    std::atomic<bool> producerWaiting{false};
+    std::atomic<bool> consumerWaiting{false};
+    std::atomic<bool> flushing{false};
+    std::atomic<bool> isPaused{false};
+
+    std::function<void(T)> recycler;
+
+    std::mutex parkMtx;
+    std::condition_variable dataCond;
+    std::condition_variable spaceCond;
+
+    bool hasSpace(size_t t) const {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t d = drainTo.load(std::memory_order_acquire);
+        return t - std::max(h, d) < maxSize.load(std::memory_order_relaxed) && t - h <= mask;
+    }
+
+    // 不考虑队列大小，只看环形缓冲是否还有空槽
+    bool hasCapacity(size_t t) const {
+        return t - head.load(std::memory_order_acquire) <= mask;
+    }
+
+    // 需持有consumerBusy
+    void discardStale() {
+        size_t h = head.load(std::memory_order_relaxed);
+        const size_t d = drainTo.load(std::memory_order_acquire);
+        if (h >= d) return;
+
+        while (h < d) {
+            if (recycler) {
+                recycler(buffer[h & mask]);
+            } else {
+                releaseItem(buffer[h & mask]);
+            }
+            buffer[h & mask] = T();
+            ++h;
+        }
+        head.store(h, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producerWaiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(parkMtx);
+            spaceCond.notify_one();
+        }
+    }
+
+    static void releaseItem(T& item) {
+        if constexpr (std::is_pointer<T>::value) {
+            if (!item) return;
+            if constexpr (std::is_same<T, AVPacket*>::value) {
+                av_packet_free(&item);
+            } else if constexpr (std::is_same<T, AVFrame*>::value) {
+                av_frame_free(&item);
+            } else {
+                delete item;
+            }
+        }
+    }
+};
+
+#endif //GLMEDIAKIT_SPSCQUEUE_HPP
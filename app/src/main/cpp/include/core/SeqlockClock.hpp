@@ -0,0 +1,101 @@
+//
+// Created by Weichuandong on 2025/4/26.
+//
+
+#ifndef GLMEDIAKIT_SEQLOCKCLOCK_HPP
+#define GLMEDIAKIT_SEQLOCKCLOCK_HPP
+
+#include "core/IClock.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+/**
+ * 以seqlock发布的时钟，pts和lastUpdateTime总是成对读出
+ *
+ * - 序号为奇数表示正在写入。写端用CAS把序号从偶数改为奇数后写入数据，再加一变回偶数；
+ *   同一个时钟允许多个写端(音频回调更新和Player线程seek时reset)，写端之间短暂自旋
+ * - 读端不加锁: 读序号 -> 读数据 -> 再读序号，两次一致且为偶数时数据有效，否则重试
+ * - 数据用原子的64位整数保存double的位模式，避免读写同一内存的数据竞争
+ *
+ * 写入只有两次relaxed存储和两次序号操作，可以在OpenSL ES回调中调用。
+ * */
+class SeqlockClock {
+public:
+    void store(const IClock& clock) {
+        uint64_t seq = sequence.load(std::memory_order_relaxed);
+        int spins = 0;
+        for (;;) {
+            if (seq & 1) {
+                // 另一个写端正在写入，临界区只有两次存储
+                backoff(spins);
+                seq = sequence.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        pts.store(toBits(clock.pts), std::memory_order_relaxed);
+        lastUpdateTime.store(toBits(clock.lastUpdateTime), std::memory_order_relaxed);
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    IClock load() const {
+        IClock clock;
+        int spins = 0;
+        for (;;) {
+            uint64_t begin = sequence.load(std::memory_order_acquire);
+            if (begin & 1) {
+                backoff(spins);
+                continue;
+            }
+
+            clock.pts = fromBits(pts.load(std::memory_order_relaxed));
+            clock.lastUpdateTime = fromBits(lastUpdateTime.load(std::memory_order_relaxed));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == begin) {
+                return clock;
+            }
+        }
+    }
+
+    double getCurrentTime(double speed = 1.0) const {
+        return load().getCurrentTime(speed);
+    }
+
+private:
+    // 先自旋，写端迟迟没有完成(例如在单核上被抢占)时让出CPU
+    static constexpr int SPIN_LIMIT = 64;
+
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> pts{0};
+    std::atomic<uint64_t> lastUpdateTime{0};
+
+    static void backoff(int& spins) {
+        if (++spins > SPIN_LIMIT) {
+            std::this_thread::yield();
+        }
+    }
+
+    static uint64_t toBits(double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static double fromBits(uint64_t bits) {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+#endif //GLMEDIAKIT_SEQLOCKCLOCK_HPP
@@ -0,0 +1,261 @@
+//
+// Created by Weichuandong on 2025/4/22.
+//
+
+#ifndef GLMEDIAKIT_TRACE_HPP
+#define GLMEDIAKIT_TRACE_HPP
+
+/**
+ * 低开销的事件追踪，导出为Chrome trace JSON(chrome://tracing或ui.perfetto.dev打开)
+ *
+ * - 编译时定义GLMEDIAKIT_ENABLE_TRACE(CMake选项GLMEDIAKIT_TRACE)才生效，否则所有TRACE_*宏展开为空
+ * - 每个线程第一次记录时注册一个自己的环形缓冲区，记录只写本线程的缓冲区，不加锁；
+ *   缓冲区写满后覆盖最旧的事件，所以导出的是每个线程最近的一段事件
+ * - 运行时通过Trace::start()/stop()开关，未开启时每个追踪点只有一次原子读
+ * - 事件名必须是字符串字面量(只保存指针)
+ *
+ * 用法:
+ *   TRACE_THREAD_NAME("demux");              // 线程名，显示在trace的线程行上
+ *   { TRACE_SCOPE("decode_video"); ... }      // 作用域耗时
+ *   TRACE_INSTANT("drop_stale_frame");        // 瞬时事件
+ *   TRACE_COUNTER("video_frame_queue", size); // 计数器曲线
+ *   Trace::start(); ...; Trace::stop(); Trace::dumpChromeJson("/sdcard/trace.json");
+ * */
+
+#if defined(GLMEDIAKIT_ENABLE_TRACE)
+
+#define GLMEDIAKIT_TRACE_ENABLED 1
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+struct TraceEvent {
+    uint64_t timestampNs;   // steady_clock
+    const char* name;
+    int64_t value;          // 'X'为持续时间(ns)，'C'为计数值
+    char phase;             // 'X' 作用域, 'B'/'E' 开始/结束, 'i' 瞬时, 'C' 计数器
+};
+
+// 单个线程的环形缓冲区: 只有所属线程写入，导出时其他线程读取
+class TraceBuffer {
+public:
+    static constexpr size_t CAPACITY = 1 << 14;     // 每个线程16K个事件(约512KB)
+
+    TraceBuffer(int tid, std::string name) :
+        events(CAPACITY),
+        tid(tid),
+        threadName(std::move(name)) {}
+
+    void record(char phase, const char* name, int64_t value, uint64_t timestampNs) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        TraceEvent& event = events[h & (CAPACITY - 1)];
+        event.timestampNs = timestampNs;
+        event.name = name;
+        event.value = value;
+        event.phase = phase;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // 复制仍然有效的事件，复制过程中被写入线程覆盖的部分会被丢弃
+    void snapshot(std::vector<TraceEvent>& out) const {
+        const uint64_t end = head.load(std::memory_order_acquire);
+        const uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+        const size_t base = out.size();
+        for (uint64_t i = begin; i < end; ++i) {
+            out.push_back(events[i & (CAPACITY - 1)]);
+        }
+
+        const uint64_t newHead = head.load(std::memory_order_acquire);
+        if (newHead > CAPACITY && newHead - CAPACITY > begin) {
+            size_t overwritten = std::min<uint64_t>(newHead - CAPACITY - begin, end - begin);
+            out.erase(out.begin() + base, out.begin() + base + overwritten);
+        }
+    }
+
+    int getTid() const { return tid; }
+    const std::string& getThreadName() const { return threadName; }
+    void setThreadName(const char* name) { threadName = name; }
+
+private:
+    std::vector<TraceEvent> events;
+    alignas(64) std::atomic<uint64_t> head{0};
+    const int tid;
+    std::string threadName;     // 只在注册和导出时访问，由Trace::mtx保护
+};
+
+class Trace {
+public:
+    static void start() {
+        instance().startNs.store(nowNs(), std::memory_order_relaxed);
+        instance().enabled.store(true, std::memory_order_release);
+    }
+
+    static void stop() {
+        instance().enabled.store(false, std::memory_order_release);
+    }
+
+    static bool isEnabled() {
+        return instance().enabled.load(std::memory_order_relaxed);
+    }
+
+    static uint64_t nowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void record(char phase, const char* name, int64_t value = 0, uint64_t timestampNs = 0) {
+        if (!isEnabled()) return;
+        localBuffer()->record(phase, name, value, timestampNs ? timestampNs : nowNs());
+    }
+
+    static void setThreadName(const char* name) {
+        TraceBuffer* buffer = localBuffer();
+        std::lock_guard<std::mutex> lock(instance().mtx);
+        buffer->setThreadName(name);
+    }
+
+    // 导出start()之后的事件，建议先stop()，避免导出期间继续覆盖
+    static bool dumpChromeJson(const std::string& path) {
+        FILE* file = fopen(path.c_str(), "w");
+        if (!file) return false;
+
+        Trace& trace = instance();
+        const uint64_t startNs = trace.startNs.load(std::memory_order_relaxed);
+
+        std::vector<std::shared_ptr<TraceBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(trace.mtx);
+            buffers = trace.buffers;
+        }
+
+        fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        bool first = true;
+        std::vector<TraceEvent> events;
+        for (const auto& buffer : buffers) {
+            {
+                std::lock_guard<std::mutex> lock(trace.mtx);
+                fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                              "\"args\":{\"name\":\"%s\"}}",
+                        first ? "" : ",\n", buffer->getTid(), buffer->getThreadName().c_str());
+            }
+            first = false;
+
+            events.clear();
+            buffer->snapshot(events);
+            for (const TraceEvent& e : events) {
+                if (e.timestampNs < startNs) continue;
+                double ts = (e.timestampNs - startNs) / 1000.0;   // Chrome trace以微秒为单位
+                switch (e.phase) {
+                    case 'X':
+                        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                                e.name, buffer->getTid(), ts, e.value / 1000.0);
+                        break;
+                    case 'C':
+                        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+                                      "\"args\":{\"value\":%lld}}",
+                                e.name, buffer->getTid(), ts, (long long)e.value);
+                        break;
+                    case 'i':
+                        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+                                e.name, buffer->getTid(), ts);
+                        break;
+                    default:
+                        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+                                e.name, e.phase, buffer->getTid(), ts);
+                        break;
+                }
+            }
+        }
+        fprintf(file, "\n]}\n");
+        fclose(file);
+        return true;
+    }
+
+private:
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> startNs{0};
+    std::mutex mtx;
+    // 线程退出后缓冲区仍然保留，用于导出
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+
+    static Trace& instance() {
+        static Trace trace;
+        return trace;
+    }
+
+    static TraceBuffer* localBuffer() {
+        thread_local TraceBuffer* buffer = nullptr;
+        if (!buffer) {
+            Trace& trace = instance();
+            std::lock_guard<std::mutex> lock(trace.mtx);
+            int tid = (int)trace.buffers.size() + 1;
+            trace.buffers.push_back(std::make_shared<TraceBuffer>(tid, "thread-" + std::to_string(tid)));
+            buffer = trace.buffers.back().get();
+        }
+        return buffer;
+    }
+};
+
+// 作用域结束时记录一个完整事件('X')
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) :
+        name(name),
+        beginNs(Trace::isEnabled() ? Trace::nowNs() : 0) {}
+
+    ~TraceScope() {
+        if (beginNs) {
+            Trace::record('X', name, (int64_t)(Trace::nowNs() - beginNs), beginNs);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t beginNs;
+};
+
+#define GLMEDIAKIT_TRACE_CONCAT_(a, b) a##b
+#define GLMEDIAKIT_TRACE_CONCAT(a, b) GLMEDIAKIT_TRACE_CONCAT_(a, b)
+
+#define TRACE_SCOPE(name) TraceScope GLMEDIAKIT_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_BEGIN(name) Trace::record('B', name)
+#define TRACE_END(name) Trace::record('E', name)
+#define TRACE_INSTANT(name) Trace::record('i', name)
+#define TRACE_COUNTER(name, value) Trace::record('C', name, (int64_t)(value))
+#define TRACE_THREAD_NAME(name) Trace::setThreadName(name)
+
+#else
+
+#define GLMEDIAKIT_TRACE_ENABLED 0
+
+#include <string>
+
+// 未开启追踪时保留接口，调用方不需要条件编译
+class Trace {
+public:
+    static void start() {}
+    static void stop() {}
+    static bool isEnabled() { return false; }
+    static bool dumpChromeJson(const std::string&) { return false; }
+};
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+#endif //GLMEDIAKIT_TRACE_HPP
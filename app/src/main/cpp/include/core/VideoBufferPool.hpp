@@ -0,0 +1,177 @@
+//
+// Created by Weichuandong on 2025/5/3.
+//
+
+#ifndef GLMEDIAKIT_VIDEOBUFFERPOOL_HPP
+#define GLMEDIAKIT_VIDEOBUFFERPOOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+};
+
+#include "platform/FFmpegCompat.h"
+
+/**
+ * 软解码器的帧缓冲区池，作为AVCodecContext::get_buffer2使用
+ *
+ * 每帧的所有平面放在一块连续的缓冲区中，起始地址和每个平面都按ALIGNMENT(64字节)对齐，
+ * 每行字节数(linesize)也是ALIGNMENT的整数倍，上传纹理时可以直接以linesize作为GL_UNPACK_ROW_LENGTH，
+ * 驱动不需要重新排列行。整帧的布局(Layout)只由像素格式和对齐后的宽高决定，
+ * 以后换成映射的像素缓冲(PBO)时，同样的布局可以让解码结果一次拷贝到GPU。
+ *
+ * 缓冲区来自AVBufferPool，帧被消费者释放后回到池中，稳定播放时没有逐帧分配。
+ * 分辨率或像素格式变化时换一个新池，旧池在它的缓冲区全部释放后由FFmpeg回收。
+ * 硬件帧、调色板等非普通平面格式交给avcodec_default_get_buffer2。
+ * */
+class VideoBufferPool {
+public:
+    static constexpr int ALIGNMENT = 64;
+
+    struct Layout {
+        int linesize[4]{};
+        size_t offset[4]{};
+        size_t size{0};         // 包括末尾给解码器越界读写预留的空间
+    };
+
+    VideoBufferPool() = default;
+
+    ~VideoBufferPool() {
+        av_buffer_pool_uninit(&pool);
+    }
+
+    VideoBufferPool(const VideoBufferPool&) = delete;
+    VideoBufferPool& operator=(const VideoBufferPool&) = delete;
+
+    // 把pool设置到解码器上，需要在avcodec_open2()之前调用。解码器不支持自定义缓冲区(没有DR1)时返回false
+    static bool attach(AVCodecContext* ctx, VideoBufferPool* pool) {
+        if (!ctx->codec || !(ctx->codec->capabilities & AV_CODEC_CAP_DR1)) return false;
+        ctx->opaque = pool;
+        ctx->get_buffer2 = getBuffer2;
+#if FF_API_THREAD_SAFE_CALLBACKS
+        // 旧版本帧级多线程时默认把回调转到调用线程串行执行，getBuffer2本身是线程安全的
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+        ctx->thread_safe_callbacks = 1;
+#pragma GCC diagnostic pop
+#endif
+        return true;
+    }
+
+    // width/height为avcodec_align_dimensions2()对齐后的尺寸，不支持的格式返回false
+    static bool computeLayout(AVPixelFormat format, int width, int height, Layout& layout) {
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+        if (!desc || width <= 0 || height <= 0 ||
+            (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM))) {
+            return false;
+        }
+
+        // 与avcodec_default_get_buffer2相同: 逐步加大宽度的对齐，直到每个平面的linesize都是ALIGNMENT的整数倍
+        int w = width;
+        for (;;) {
+            if (av_image_fill_linesizes(layout.linesize, format, w) < 0) return false;
+            bool aligned = true;
+            for (int i = 0; i < 4; ++i) {
+                if (layout.linesize[i] % ALIGNMENT) aligned = false;
+            }
+            if (aligned) break;
+            w += w & ~(w - 1);
+        }
+
+        ptrdiff_t linesizes[4];
+        size_t planeSizes[4];
+        for (int i = 0; i < 4; ++i) linesizes[i] = layout.linesize[i];
+        if (av_image_fill_plane_sizes(planeSizes, format, height, linesizes) < 0) return false;
+
+        size_t offset = 0;
+        for (int i = 0; i < 4; ++i) {
+            layout.offset[i] = planeSizes[i] ? offset : 0;
+            offset += (planeSizes[i] + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+        // 部分解码器的SIMD代码会越过平面末尾读写最多一个对齐单位
+        layout.size = offset + ALIGNMENT + AV_INPUT_BUFFER_PADDING_SIZE;
+        return true;
+    }
+
+    static int getBuffer2(AVCodecContext* ctx, AVFrame* frame, int flags) {
+        auto* self = static_cast<VideoBufferPool*>(ctx->opaque);
+        if (!self) return avcodec_default_get_buffer2(ctx, frame, flags);
+
+        int width = frame->width;
+        int height = frame->height;
+        int linesizeAlign[AV_NUM_DATA_POINTERS];
+        avcodec_align_dimensions2(ctx, &width, &height, linesizeAlign);
+
+        Layout layout;
+        AVBufferRef* buf = self->get(static_cast<AVPixelFormat>(frame->format), width, height, layout);
+        if (!buf) return avcodec_default_get_buffer2(ctx, frame, flags);
+
+        frame->buf[0] = buf;
+        for (int i = 0; i < 4; ++i) {
+            frame->data[i] = layout.linesize[i] ? buf->data + layout.offset[i] : nullptr;
+            frame->linesize[i] = layout.linesize[i];
+        }
+        frame->extended_data = frame->data;
+        return 0;
+    }
+
+    // 池中实际分配过的缓冲区个数，稳定播放时不再增长
+    uint64_t getAllocCount() const { return allocCount.load(std::memory_order_relaxed); }
+    uint64_t getRequestCount() const { return requestCount.load(std::memory_order_relaxed); }
+
+    size_t getBufferSize() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return currentLayout.size;
+    }
+
+private:
+    std::mutex mtx;
+    AVBufferPool* pool{nullptr};
+    AVPixelFormat currentFormat{AV_PIX_FMT_NONE};
+    int currentWidth{0};
+    int currentHeight{0};
+    Layout currentLayout;
+
+    std::atomic<uint64_t> allocCount{0};
+    std::atomic<uint64_t> requestCount{0};
+
+    AVBufferRef* get(AVPixelFormat format, int width, int height, Layout& layout) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!pool || format != currentFormat || width != currentWidth || height != currentHeight) {
+            Layout newLayout;
+            if (!computeLayout(format, width, height, newLayout)) return nullptr;
+            av_buffer_pool_uninit(&pool);
+            pool = av_buffer_pool_init2(newLayout.size, this, allocAligned, nullptr);
+            if (!pool) return nullptr;
+            currentFormat = format;
+            currentWidth = width;
+            currentHeight = height;
+            currentLayout = newLayout;
+        }
+        layout = currentLayout;
+        requestCount.fetch_add(1, std::memory_order_relaxed);
+        return av_buffer_pool_get(pool);
+    }
+
+    // 只在池为空时由av_buffer_pool_get()调用(持有mtx)
+    static AVBufferRef* allocAligned(void* opaque, BufferSize size) {
+        void* data = nullptr;
+        if (posix_memalign(&data, ALIGNMENT, size) != 0) return nullptr;
+        AVBufferRef* buf = av_buffer_create(static_cast<uint8_t*>(data), size,
+                                            [](void*, uint8_t* p) { free(p); }, nullptr, 0);
+        if (!buf) {
+            free(data);
+            return nullptr;
+        }
+        static_cast<VideoBufferPool*>(opaque)->allocCount.fetch_add(1, std::memory_order_relaxed);
+        return buf;
+    }
+};
+
+#endif //GLMEDIAKIT_VIDEOBUFFERPOOL_HPP
@@ -0,0 +1,46 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#ifndef GLMEDIAKIT_IAUDIOSINK_H
+#define GLMEDIAKIT_IAUDIOSINK_H
+
+extern "C" {
+#include "libavutil/rational.h"
+#include "libavutil/samplefmt.h"
+}
+
+/**
+ * 音频输出设备，从音频帧队列中拉取数据并上报音频时钟
+ * Android上为OpenSL ES，桌面环境为空输出/写文件(见platform/Platform.h)
+ * */
+class IAudioSink {
+public:
+    virtual ~IAudioSink() = default;
+
+    // 按输入音频参数初始化输出设备
+    virtual bool prepare(int sampleRate, int channels, AVSampleFormat format) = 0;
+
+    // 控制播放
+    virtual void start() = 0;
+    virtual void pause() = 0;
+    virtual void resume() = 0;
+    virtual void stop() = 0;
+    virtual void release() = 0;
+
+    // 音量控制
+    virtual void setVolume(float vol) = 0;
+    virtual float getVolume() const = 0;
+
+    virtual bool isReadying() = 0;
+
+    virtual void setTimeBase(const AVRational& timeBase) = 0;
+
+    // 播放速度(0.25~4.0)，变速不变调
+    virtual void setPlaybackRate(float rate) = 0;
+
+    // 已提交给设备但还没有播放的数据时长(秒)，音频时钟据此换算实际播放位置
+    virtual double getLatency() = 0;
+};
+
+#endif //GLMEDIAKIT_IAUDIOSINK_H
@@ -11,8 +11,8 @@
 #include "interface/IMediaData.h"
 
 extern "C" {
-#include "ffmpeg/include/libavformat/avformat.h"
-#include "ffmpeg/include/libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
 }
 
 class DecoderConfig {
@@ -61,6 +61,9 @@ public:
     virtual bool isReadying() = 0;
 
     virtual bool configure(const DecoderConfig& config) = 0;
+
+    // seek后丢弃解码器内部缓存的数据(参考帧、待输出的帧)，之后可以从新的关键帧继续解码
+    virtual void flush() = 0;
 };
 
 
@@ -73,6 +76,15 @@ public:
     virtual int getHeight() = 0;
 
     virtual PixFormat getPixFormat() = 0;
+
+    // 解码时跳过的帧类型(AVCodecContext::skip_frame)，不支持的解码器忽略
+    virtual void setFrameDiscard(AVDiscard /*discard*/) {}
+
+    // 按当前播放速度每帧可用的时间(秒)，解码耗时超过它时软解逐级降质，不支持的解码器忽略
+    virtual void setFrameInterval(double /*seconds*/) {}
+
+    // 当前的降质级别，0为完整质量
+    virtual int getQualityLevel() { return 0; }
 };
 
 class IAudioDecoder : public IDecoder {
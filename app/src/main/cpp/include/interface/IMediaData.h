@@ -39,7 +39,7 @@ enum class SampleFormat {
 
 class IMediaPacket {
 public:
-    ~IMediaPacket() = default;
+    virtual ~IMediaPacket() = default;
 
     virtual const uint8_t* getData() const = 0;
     virtual const size_t getSize() const = 0;
@@ -51,7 +51,7 @@ public:
 
 class IMediaFrame {
 public:
-    ~IMediaFrame() = default;
+    virtual ~IMediaFrame() = default;
 
     virtual const int64_t getPts() const = 0;
     // 视频特有属性
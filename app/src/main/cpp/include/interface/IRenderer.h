@@ -6,7 +6,7 @@
 #define GLMEDIAKIT_IRENDERER_H
 
 extern "C" {
-#include "ffmpeg/include/libavcodec/avcodec.h"
+#include "libavcodec/avcodec.h"
 };
 
 class IRenderer {
@@ -25,7 +25,7 @@ public:
     // 处理视口变化
     virtual void onSurfaceChanged(int width, int height) = 0;
 
-    // 绘制一帧
+    // 绘制一帧, frame的所有权仍属于调用方
     virtual void onDrawFrame() = 0;
     virtual void onDrawFrame(AVFrame* frame) = 0;
 
@@ -8,9 +8,9 @@
 #include "interface/IMediaData.h"
 #include <memory>
 
-class FFmpegFrame : public IMediaFrame {
+class FFmpegFrame final : public IMediaFrame {
 public:
-    FFmpegFrame(AVFrame* data) :
+    explicit FFmpegFrame(AVFrame* data = nullptr) :
         frame(data){}
 
     virtual ~FFmpegFrame(){
@@ -45,6 +45,9 @@ public:
 
     AVFrame * asAVFrame() override{ return frame;}
 
+    // 与FFmpegPacket::rebind相同，复用包装对象
+    void rebind(AVFrame* data) { frame = data; }
+
     static std::shared_ptr<FFmpegFrame> fromAVFrame(AVFrame* frame) {
         AVFrame* clone = av_frame_clone(frame);
         if (!clone) {
@@ -8,9 +8,9 @@
 #include "interface/IMediaData.h"
 #include <memory>
 
-class FFmpegPacket : public IMediaPacket {
+class FFmpegPacket final : public IMediaPacket {
 public:
-    explicit FFmpegPacket(AVPacket* data) :
+    explicit FFmpegPacket(AVPacket* data = nullptr) :
         packet(data) {}
 
     virtual ~FFmpegPacket() {
@@ -27,6 +27,9 @@ public:
 
     virtual AVPacket* asAVPacket() const override { return packet; }
 
+    // 解码线程内复用同一个包装对象，每个packet只需重新绑定，不再make_shared
+    void rebind(AVPacket* data) { packet = data; }
+
     static std::shared_ptr<FFmpegPacket> fromAVPacket(AVPacket* packet) {
         AVPacket* clone = av_packet_clone(packet);
         if (!clone) {
@@ -37,7 +40,7 @@ public:
     }
 
     const int64_t getTs() override {
-
+        return packet->pts;
     }
 
 private:
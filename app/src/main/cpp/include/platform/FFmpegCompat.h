@@ -0,0 +1,91 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#ifndef GLMEDIAKIT_FFMPEGCOMPAT_H
+#define GLMEDIAKIT_FFMPEGCOMPAT_H
+
+/**
+ * FFmpeg版本差异
+ *
+ * APK使用3rdparty中的FFmpeg 4.4，实验性的桌面构建使用系统FFmpeg(可能是5.1之后的版本，未经链接验证)。
+ * 5.1引入AVChannelLayout(ch_layout)，旧的channels/channel_layout字段在7.0中被删除；
+ * AVFrame::pkt_duration在6.0后由AVFrame::duration代替。
+ * */
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+#include <libavutil/channel_layout.h>
+#include <libswresample/swresample.h>
+};
+
+#define GLMEDIAKIT_HAS_CH_LAYOUT (LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 28, 100))
+#define GLMEDIAKIT_HAS_FRAME_DURATION (LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(57, 30, 100))
+
+// FF_PROFILE_UNKNOWN/FF_LEVEL_UNKNOWN在6.1后由AV_PROFILE_UNKNOWN/AV_LEVEL_UNKNOWN代替，之后的版本中被删除
+#ifndef FF_PROFILE_UNKNOWN
+#define FF_PROFILE_UNKNOWN AV_PROFILE_UNKNOWN
+#endif
+#ifndef FF_LEVEL_UNKNOWN
+#define FF_LEVEL_UNKNOWN AV_LEVEL_UNKNOWN
+#endif
+
+// AVBuffer接口的大小参数在5.0(libavutil 57)由int改为size_t
+#if FF_API_BUFFER_SIZE_T
+typedef int BufferSize;
+#else
+typedef size_t BufferSize;
+#endif
+
+inline int getChannelCount(const AVCodecContext* ctx) {
+#if GLMEDIAKIT_HAS_CH_LAYOUT
+    return ctx->ch_layout.nb_channels;
+#else
+    return ctx->channels;
+#endif
+}
+
+inline int getChannelCount(const AVFrame* frame) {
+#if GLMEDIAKIT_HAS_CH_LAYOUT
+    return frame->ch_layout.nb_channels;
+#else
+    return frame->channels;
+#endif
+}
+
+inline int64_t getFrameDuration(const AVFrame* frame) {
+#if GLMEDIAKIT_HAS_FRAME_DURATION
+    return frame->duration;
+#else
+    return frame->pkt_duration;
+#endif
+}
+
+// 创建并初始化重采样上下文，输入按声道数使用默认布局，失败返回nullptr
+inline SwrContext* createSwrContext(int outChannels, AVSampleFormat outFormat, int outSampleRate,
+                                    int inChannels, AVSampleFormat inFormat, int inSampleRate) {
+    SwrContext* swr = nullptr;
+#if GLMEDIAKIT_HAS_CH_LAYOUT
+    AVChannelLayout outLayout, inLayout;
+    av_channel_layout_default(&outLayout, outChannels);
+    av_channel_layout_default(&inLayout, inChannels);
+    int ret = swr_alloc_set_opts2(&swr, &outLayout, outFormat, outSampleRate,
+                                  &inLayout, inFormat, inSampleRate, 0, nullptr);
+    av_channel_layout_uninit(&outLayout);
+    av_channel_layout_uninit(&inLayout);
+    if (ret < 0) return nullptr;
+#else
+    swr = swr_alloc_set_opts(nullptr,
+                             av_get_default_channel_layout(outChannels), outFormat, outSampleRate,
+                             av_get_default_channel_layout(inChannels), inFormat, inSampleRate,
+                             0, nullptr);
+    if (!swr) return nullptr;
+#endif
+    if (swr_init(swr) < 0) {
+        swr_free(&swr);
+        return nullptr;
+    }
+    return swr;
+}
+
+#endif //GLMEDIAKIT_FFMPEGCOMPAT_H
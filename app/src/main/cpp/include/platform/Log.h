@@ -0,0 +1,118 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#ifndef GLMEDIAKIT_LOG_H
+#define GLMEDIAKIT_LOG_H
+
+/**
+ * 日志
+ *
+ * Android上使用NDK的__android_log_print；桌面环境提供同名、同参数的实现输出到stderr。
+ *
+ * 用法: 每个.cpp在第一个#include之前定义自己的TAG，然后使用LOGV/LOGD/LOGI/LOGW/LOGE
+ *   #define LOG_TAG "RenderThread"
+ *   #include "RenderThread.h"
+ *   ...
+ *   LOGI("render %d frames", count);
+ *
+ * 头文件中的内联代码不要依赖LOG_TAG，使用带TAG参数的LOGI_TAG(tag, ...)等。
+ *
+ * 级别在编译期过滤: 低于GLMEDIAKIT_LOG_LEVEL的日志宏展开为空，参数不会被求值，也不产生任何代码。
+ * 默认Debug构建为DEBUG，定义了NDEBUG(Release)时为INFO，可以用CMake选项GLMEDIAKIT_LOG_LEVEL覆盖。
+ * 需要整段代码只在某个级别下存在时(例如周期性统计)，使用 if (LOG_IS_ENABLED(DEBUG)) 或 #if LOG_IS_ENABLED(DEBUG)。
+ *
+ * 每帧都会执行的调试日志使用core/DeferredLog.hpp中的LOGD_DEFERRED，热路径上只记录参数，格式化在后台线程完成。
+ * */
+#if defined(__ANDROID__)
+
+#include <android/log.h>
+
+#else
+
+#include <cstdio>
+#include <cstdarg>
+
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+} android_LogPriority;
+
+inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    static const char levels[] = "??VDIWEF ";
+    char level = prio >= 0 && prio <= ANDROID_LOG_SILENT ? levels[prio] : '?';
+
+    fprintf(stderr, "%c/%s: ", level, tag);
+    va_list args;
+    va_start(args, fmt);
+    int ret = vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+    return ret;
+}
+
+#endif
+
+#define GLMEDIAKIT_LOG_LEVEL_VERBOSE 0
+#define GLMEDIAKIT_LOG_LEVEL_DEBUG   1
+#define GLMEDIAKIT_LOG_LEVEL_INFO    2
+#define GLMEDIAKIT_LOG_LEVEL_WARN    3
+#define GLMEDIAKIT_LOG_LEVEL_ERROR   4
+#define GLMEDIAKIT_LOG_LEVEL_NONE    5
+
+#ifndef GLMEDIAKIT_LOG_LEVEL
+#if defined(NDEBUG)
+#define GLMEDIAKIT_LOG_LEVEL GLMEDIAKIT_LOG_LEVEL_INFO
+#else
+#define GLMEDIAKIT_LOG_LEVEL GLMEDIAKIT_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// level为VERBOSE/DEBUG/INFO/WARN/ERROR，预处理和普通表达式中都可以使用
+#define LOG_IS_ENABLED(level) (GLMEDIAKIT_LOG_LEVEL <= GLMEDIAKIT_LOG_LEVEL_##level)
+
+#if LOG_IS_ENABLED(VERBOSE)
+#define LOGV_TAG(tag, ...) __android_log_print(ANDROID_LOG_VERBOSE, tag, __VA_ARGS__)
+#else
+#define LOGV_TAG(tag, ...) ((void)0)
+#endif
+
+#if LOG_IS_ENABLED(DEBUG)
+#define LOGD_TAG(tag, ...) __android_log_print(ANDROID_LOG_DEBUG, tag, __VA_ARGS__)
+#else
+#define LOGD_TAG(tag, ...) ((void)0)
+#endif
+
+#if LOG_IS_ENABLED(INFO)
+#define LOGI_TAG(tag, ...) __android_log_print(ANDROID_LOG_INFO, tag, __VA_ARGS__)
+#else
+#define LOGI_TAG(tag, ...) ((void)0)
+#endif
+
+#if LOG_IS_ENABLED(WARN)
+#define LOGW_TAG(tag, ...) __android_log_print(ANDROID_LOG_WARN, tag, __VA_ARGS__)
+#else
+#define LOGW_TAG(tag, ...) ((void)0)
+#endif
+
+#if LOG_IS_ENABLED(ERROR)
+#define LOGE_TAG(tag, ...) __android_log_print(ANDROID_LOG_ERROR, tag, __VA_ARGS__)
+#else
+#define LOGE_TAG(tag, ...) ((void)0)
+#endif
+
+// LOG_TAG在展开时才取值，由使用日志的.cpp定义
+#define LOGV(...) LOGV_TAG(LOG_TAG, __VA_ARGS__)
+#define LOGD(...) LOGD_TAG(LOG_TAG, __VA_ARGS__)
+#define LOGI(...) LOGI_TAG(LOG_TAG, __VA_ARGS__)
+#define LOGW(...) LOGW_TAG(LOG_TAG, __VA_ARGS__)
+#define LOGE(...) LOGE_TAG(LOG_TAG, __VA_ARGS__)
+
+#endif //GLMEDIAKIT_LOG_H
@@ -0,0 +1,39 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#ifndef GLMEDIAKIT_PLATFORM_H
+#define GLMEDIAKIT_PLATFORM_H
+
+/**
+ * 平台相关组件的创建入口
+ *
+ * 实现分别在src/platform/android和src/platform/desktop中，由CMake按目标平台选择其中一个编译，
+ * 核心流程(读取、解码、队列、同步)只依赖这里的接口。
+ * */
+#include <memory>
+
+#include "interface/IAudioSink.h"
+#include "interface/IDecoder.h"
+#include "core/SPSCQueue.hpp"
+#include "core/FramePool.hpp"
+#include "core/MediaSynchronizer.hpp"
+#include "platform/Window.h"
+#include "Decoder/DecoderFactory.h"
+
+// 创建音频输出: Android上为OpenSL ES；桌面环境默认空输出，
+// 设置环境变量GLMEDIAKIT_AUDIO_FILE时写入该WAV文件
+std::unique_ptr<IAudioSink> createAudioSink(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                                            std::shared_ptr<FramePool> framePool,
+                                            std::shared_ptr<MediaSynchronizer> sync);
+
+// 平台硬件解码器支持的编码格式和profile/level/分辨率范围，DecoderFactory据此决定是否尝试硬解。
+// 不支持硬解的平台返回空
+std::vector<DecoderFactory::Caps> getHardwareVideoDecoderCaps();
+
+// 创建并配置硬件视频解码器，平台不支持该编码格式或配置失败时返回nullptr，由调用方回退到软解
+// needAnnexB: 解码器要求输入Annex-B码流(mp4中的AVCC/hvcC需要经过mp4toannexb转换)
+std::unique_ptr<IVideoDecoder> createHardwareVideoDecoder(AVCodecParameters* codecParameters,
+                                                          bool& needAnnexB);
+
+#endif //GLMEDIAKIT_PLATFORM_H
@@ -0,0 +1,32 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#ifndef GLMEDIAKIT_WINDOW_H
+#define GLMEDIAKIT_WINDOW_H
+
+/**
+ * 渲染目标窗口
+ *
+ * Android上是Surface对应的ANativeWindow，由EGLCore持有并在释放surface时release；
+ * 桌面环境(实验性的GLMediaKitCore)只构建读取/解码部分，窗口句柄按不透明指针处理。
+ * */
+#if defined(__ANDROID__)
+
+#include <android/native_window.h>
+
+typedef ANativeWindow NativeWindow;
+
+inline void releaseNativeWindow(NativeWindow* window) {
+    if (window) ANativeWindow_release(window);
+}
+
+#else
+
+typedef void NativeWindow;
+
+inline void releaseNativeWindow(NativeWindow* /*window*/) {}
+
+#endif
+
+#endif //GLMEDIAKIT_WINDOW_H
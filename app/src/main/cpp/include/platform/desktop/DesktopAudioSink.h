@@ -0,0 +1,125 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#ifndef GLMEDIAKIT_DESKTOPAUDIOSINK_H
+#define GLMEDIAKIT_DESKTOPAUDIOSINK_H
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+#include "platform/Log.h"
+#include "interface/IAudioSink.h"
+#include "AudioFrameConverter.h"
+
+/**
+ * 桌面环境的音频输出：用一个线程模拟声卡回调，周期性地从帧队列拉取数据交给write()
+ *
+ * realtime为true时按输出采样率控制拉取速度(与真实设备一样驱动音频时钟)，
+ * 为false时尽可能快地消费，用于测量解码吞吐。
+ * */
+class DesktopAudioSink : public IAudioSink {
+public:
+    DesktopAudioSink(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                     std::shared_ptr<FramePool> framePool,
+                     std::shared_ptr<MediaSynchronizer> sync,
+                     bool realtime);
+    ~DesktopAudioSink() override;
+
+    bool prepare(int sampleRate, int channels, AVSampleFormat format) override;
+
+    void start() override;
+    void pause() override;
+    void resume() override;
+    void stop() override;
+    void release() override;
+
+    void setVolume(float vol) override { converter.setVolume(vol); }
+    float getVolume() const override { return converter.getVolume(); }
+
+    bool isReadying() override { return isReady; }
+
+    void setTimeBase(const AVRational& timeBase) override { converter.setTimeBase(timeBase); }
+    void setPlaybackRate(float rate) override { converter.setPlaybackRate(rate); }
+    double getLatency() override;
+
+    // 已输出的PCM字节数
+    uint64_t getWrittenBytes() const { return writtenBytes.load(std::memory_order_relaxed); }
+
+protected:
+    static constexpr int OUT_SAMPLE_RATE = 44100;
+    static constexpr int OUT_CHANNELS = 2;
+
+    // 打开输出设备，输出格式为OUT_SAMPLE_RATE/OUT_CHANNELS的16位交织PCM
+    virtual bool onOpen() { return true; }
+    // 在拉取线程中调用
+    virtual void write(const uint8_t* data, int size) = 0;
+    virtual void onClose() {}
+
+private:
+    // 每次拉取的数据量，与SLAudioPlayer的缓冲区大小一致
+    static const int BUFFER_SIZE = 8192;
+    static const int POP_TIMEOUT_MS = 10;
+
+    AudioFrameConverter converter;
+    std::vector<uint8_t> audioBuffer;
+    const bool realtime;
+
+    std::thread playThread;
+    std::mutex mutex;
+    std::condition_variable runCond;
+    std::atomic<bool> isRunning{false};
+    std::atomic<bool> isReady{false};
+    std::atomic<bool> exitRequested{false};
+    std::atomic<uint64_t> writtenBytes{0};
+    // realtime时已输出的数据"播放完"的时刻(av_gettime_relative()，微秒)
+    std::atomic<int64_t> playoutEndTime{0};
+
+    void playThreadFunc();
+};
+
+// 丢弃所有数据，只推进音频时钟
+class NullAudioSink : public DesktopAudioSink {
+public:
+    NullAudioSink(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                  std::shared_ptr<FramePool> framePool,
+                  std::shared_ptr<MediaSynchronizer> sync,
+                  bool realtime = true) :
+        DesktopAudioSink(std::move(frameQueue), std::move(framePool), std::move(sync), realtime) {}
+    ~NullAudioSink() override { release(); }
+
+protected:
+    void write(const uint8_t* /*data*/, int /*size*/) override {}
+};
+
+// 输出为WAV文件，便于离线检查重采样和seek后的音频
+class FileAudioSink : public DesktopAudioSink {
+public:
+    FileAudioSink(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                  std::shared_ptr<FramePool> framePool,
+                  std::shared_ptr<MediaSynchronizer> sync,
+                  std::string path,
+                  bool realtime = false) :
+        DesktopAudioSink(std::move(frameQueue), std::move(framePool), std::move(sync), realtime),
+        filePath(std::move(path)) {}
+    ~FileAudioSink() override { release(); }
+
+protected:
+    bool onOpen() override;
+    void write(const uint8_t* data, int size) override;
+    void onClose() override;
+
+private:
+    std::string filePath;
+    FILE* file{nullptr};
+    uint32_t dataBytes{0};
+
+    void writeHeader();
+};
+
+#endif //GLMEDIAKIT_DESKTOPAUDIOSINK_H
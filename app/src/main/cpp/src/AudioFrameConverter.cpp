@@ -0,0 +1,288 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#include "AudioFrameConverter.h"
+#include "core/Trace.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+AudioFrameConverter::AudioFrameConverter(std::shared_ptr<SPSCQueue<AVFrame *>> frameQueue,
+                                         std::shared_ptr<FramePool> framePool,
+                                         std::shared_ptr<MediaSynchronizer> sync) :
+    audioFrameQueue(std::move(frameQueue)),
+    audioFramePool(std::move(framePool)),
+    synchronizer(std::move(sync))
+{
+
+}
+
+AudioFrameConverter::~AudioFrameConverter() {
+    release();
+}
+
+bool AudioFrameConverter::prepare(int inSampleRate, int inChannels, AVSampleFormat inFormat,
+                                  int outRate, int outChannelCount) {
+    release();
+
+    outSampleRate = outRate;
+    outChannels = outChannelCount;
+    stretcher.prepare(outSampleRate, outChannels);
+
+    // 输入输出都使用默认声道布局
+    swrContext = createSwrContext(outChannels, AV_SAMPLE_FMT_S16, outSampleRate,
+                                  inChannels, inFormat, inSampleRate);
+    return swrContext != nullptr;
+}
+
+void AudioFrameConverter::release() {
+    if (swrContext) {
+        swr_free(&swrContext);
+        swrContext = nullptr;
+    }
+
+    if (resampleBuffer) {
+        av_free(resampleBuffer);
+        resampleBuffer = nullptr;
+    }
+    resampleBufferSize = 0;
+    availableSamples = 0;
+    stretcher.clear();
+    inputEndPts = NAN;
+}
+
+int AudioFrameConverter::fill(uint8_t *buffer, int size, double queuedLatency, int timeoutMs) {
+    if (!swrContext) return 0;
+
+    int bytesFilled = 0;
+    const int bytesPerFrame = getBytesPerFrame();
+
+    // seek之后丢弃重采样缓冲区和重采样器内部残留的旧数据
+    int serial = synchronizer->getSerial();
+    if (serial != playSerial) {
+        availableSamples = 0;
+        swr_init(swrContext);
+        stretcher.clear();
+        inputEndPts = NAN;
+        playSerial = serial;
+    }
+
+    float rate = playbackRate.load();
+    if (rate != stretchRate) {
+        if (rate == 1.0f) {
+            // 恢复正常速度，未伸缩的数据原样输出
+            stretcher.flush();
+        } else {
+            stretcher.setRate(rate);
+        }
+        stretchRate = rate;
+    }
+    if (stretchRate != 1.0f) {
+        bytesFilled = fillStretched(buffer, size, timeoutMs);
+        applyVolume((int16_t*)buffer, bytesFilled / 2);
+        updateClock(bytesFilled, queuedLatency);
+        return bytesFilled;
+    }
+
+    // 刚从变速切回来时时间伸缩器中还有剩余数据
+    if (stretcher.getAvailableFrames() > 0) {
+        bytesFilled += stretcher.receiveSamples((int16_t*)buffer, size / bytesPerFrame) * bytesPerFrame;
+    }
+
+    // 如果之前重采样的数据可用
+    if (availableSamples > 0 && resampleBuffer && bytesFilled < size) {
+        int bytesAvailable = availableSamples * bytesPerFrame;
+        // 可以拷贝的字节数由缓冲区大小和可用数据量共同决定
+        int bytesToCopy = std::min(size - bytesFilled, bytesAvailable);
+
+        memcpy(buffer + bytesFilled, resampleBuffer, bytesToCopy);
+        bytesFilled += bytesToCopy;
+
+        // 如果数据还有剩余
+        if (bytesToCopy < bytesAvailable) {
+            // 部分使用，移动剩余数据
+            memmove(resampleBuffer, resampleBuffer + bytesToCopy,
+                    bytesAvailable - bytesToCopy);
+            availableSamples -= bytesToCopy / bytesPerFrame;
+        } else {
+            // 全部使用
+            availableSamples = 0;
+        }
+    }
+
+    // 如果缓冲区没有填满
+    while (bytesFilled < size) {
+        AVFrame* frame = popFrame(timeoutMs);
+        if (!frame) {
+            // 没有帧可用，由调用方决定是否补静音
+            break;
+        }
+
+        // 重采样音频帧
+        bytesFilled += resampleAudio(frame, buffer + bytesFilled, size - bytesFilled);
+        trackInputPts(frame);
+
+        audioFramePool->release(frame);
+    }
+
+    // 应用音量
+    applyVolume((int16_t*)buffer, bytesFilled / 2);
+    updateClock(bytesFilled, queuedLatency);
+    return bytesFilled;
+}
+
+int AudioFrameConverter::fillStretched(uint8_t *buffer, int size, int timeoutMs) {
+    const int bytesPerFrame = getBytesPerFrame();
+    const int framesWanted = size / bytesPerFrame;
+
+    // 切换到变速之前已经重采样但还没输出的数据
+    if (availableSamples > 0 && resampleBuffer) {
+        stretcher.putSamples((const int16_t*)resampleBuffer, availableSamples);
+        availableSamples = 0;
+    }
+
+    while (stretcher.getAvailableFrames() < framesWanted) {
+        AVFrame* frame = popFrame(timeoutMs);
+        if (!frame) break;
+
+        int samples = resampleToBuffer(frame);
+        if (samples > 0) {
+            TRACE_SCOPE("time_stretch");
+            stretcher.putSamples((const int16_t*)resampleBuffer, samples);
+        }
+        trackInputPts(frame);
+        audioFramePool->release(frame);
+    }
+
+    return stretcher.receiveSamples((int16_t*)buffer, framesWanted) * bytesPerFrame;
+}
+
+AVFrame* AudioFrameConverter::popFrame(int timeoutMs) {
+    for (;;) {
+        AVFrame* frame = nullptr;
+        if (!audioFrameQueue->pop(frame, timeoutMs) || !frame) {
+            return nullptr;
+        }
+
+        // seek之前的旧帧
+        if (getFrameSerial(frame) < playSerial) {
+            TRACE_INSTANT("audio_drop_stale_frame");
+            audioFramePool->release(frame);
+            continue;
+        }
+        return frame;
+    }
+}
+
+void AudioFrameConverter::trackInputPts(const AVFrame *frame) {
+    double duration = frame->sample_rate > 0 ? (double)frame->nb_samples / frame->sample_rate : 0;
+    if (frame->pts != AV_NOPTS_VALUE) {
+        inputEndPts = frame->pts * av_q2d(audioTimeBase) + duration;
+    } else if (!std::isnan(inputEndPts)) {
+        // 没有pts的帧按样本数顺延
+        inputEndPts += duration;
+    }
+}
+
+void AudioFrameConverter::updateClock(int bytesFilled, double queuedLatency) {
+    if (bytesFilled <= 0 || std::isnan(inputEndPts)) return;
+
+    // 已送入但还没有输出的数据: 重采样器内部延迟、重采样缓冲区剩余、变速器中的数据
+    double pending = swr_get_delay(swrContext, outSampleRate) + availableSamples
+                     + stretcher.getPendingInputFrames();
+    double outputEndPts = inputEndPts - pending / outSampleRate;
+
+    // 这次的数据要等排在前面的数据播放完之后才能播放完
+    double outputLatency = queuedLatency + (double)bytesFilled / getBytesPerFrame() / outSampleRate;
+
+    // 记录当前时间点，墙上时间按播放速度换算为媒体时间
+    audioClock.pts = outputEndPts - outputLatency * stretchRate;
+    audioClock.lastUpdateTime = av_gettime_relative() / 1000000.0;
+    // 上传到主时钟
+    synchronizer->update(audioClock, MediaSynchronizer::SyncSource::AUDIO);
+}
+
+int AudioFrameConverter::resampleToBuffer(AVFrame *frame) {
+    if (!swrContext || !frame || !frame->extended_data) return 0;
+    TRACE_SCOPE("resample");
+
+    // 计算输出样本数
+    int outSamples = av_rescale_rnd(
+            swr_get_delay(swrContext, frame->sample_rate) + frame->nb_samples,
+            outSampleRate, frame->sample_rate, AV_ROUND_UP);
+
+    // 确保重采样缓冲区足够大
+    int outBytes = outSamples * getBytesPerFrame();
+    if (outBytes > resampleBufferSize) {
+        resampleBuffer = (uint8_t*)av_realloc(resampleBuffer, outBytes);
+        resampleBufferSize = outBytes;
+    }
+
+    uint8_t* outPtr = resampleBuffer;
+    int samplesConverted = swr_convert(
+            swrContext,
+            &outPtr, outSamples,
+            (const uint8_t**)frame->extended_data, frame->nb_samples);
+
+    return samplesConverted > 0 ? samplesConverted : 0;
+}
+
+int AudioFrameConverter::resampleAudio(AVFrame *frame, uint8_t *outBuffer, int outSize) {
+    if (!swrContext || !frame || !frame->extended_data) return 0;
+
+    const int bytesPerFrame = getBytesPerFrame();
+
+    // 计算输出样本数
+    int outSamples = av_rescale_rnd(
+            swr_get_delay(swrContext, frame->sample_rate) + frame->nb_samples,
+            outSampleRate, frame->sample_rate, AV_ROUND_UP);
+
+    // 计算输出数据大小
+    int outBytes = outSamples * bytesPerFrame;
+
+    // 当前帧获取的数据量超出outBuffer的接受量
+    if (outBytes > outSize) {
+        // 先整帧重采样到中间缓冲区
+        int samplesConverted = resampleToBuffer(frame);
+        if (samplesConverted <= 0) return 0;
+
+        // 计算转换后的字节数
+        int bytesConverted = samplesConverted * bytesPerFrame;
+
+        // 复制能放入输出缓冲区的部分
+        int bytesToCopy = std::min(bytesConverted, outSize);
+        memcpy(outBuffer, resampleBuffer, bytesToCopy);
+
+        // 保存剩余的样本
+        if (bytesToCopy < bytesConverted) {
+            memmove(resampleBuffer, resampleBuffer + bytesToCopy,
+                    bytesConverted - bytesToCopy);
+            availableSamples = (bytesConverted - bytesToCopy) / bytesPerFrame;
+        }
+
+        return bytesToCopy;
+    } else {
+        TRACE_SCOPE("resample");
+        // 直接重采样到输出缓冲区
+        uint8_t* outPtr = outBuffer;
+
+        int samplesConverted = swr_convert(
+                swrContext,
+                &outPtr, outSamples,
+                (const uint8_t**)frame->extended_data, frame->nb_samples);
+
+        if (samplesConverted <= 0) return 0;
+
+        return samplesConverted * bytesPerFrame;
+    }
+}
+
+void AudioFrameConverter::applyVolume(int16_t *buffer, int numSamples) {
+    float vol = volume.load();
+    if (vol >= 0.999f) return; // 音量接近1.0，不需要处理
+
+    for (int i = 0; i < numSamples; i++) {
+        buffer[i] = (int16_t)(buffer[i] * vol);
+    }
+}
@@ -0,0 +1,173 @@
+//
+// Created by Weichuandong on 2025/4/28.
+//
+
+#include "AudioTimeStretcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+void AudioTimeStretcher::prepare(int sampleRate, int channelCount) {
+    channels = channelCount;
+    hop = sampleRate / 50;                 // 20ms
+    segment = hop * 2;
+    seekWindow = sampleRate * 12 / 1000;   // 12ms
+
+    // 周期汉宁窗，50%重叠时相加恒为1
+    window.resize(segment);
+    for (int i = 0; i < segment; ++i) {
+        window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / segment);
+    }
+    clear();
+}
+
+void AudioTimeStretcher::clear() {
+    input.clear();
+    inputStart = 0;
+    analysisPos = 0;
+    prevSegment = -1;
+    overlap.assign((size_t)hop * channels, 0.0f);
+    output.clear();
+    outputRead = 0;
+}
+
+void AudioTimeStretcher::putSamples(const int16_t* data, int frames) {
+    if (segment == 0 || frames <= 0) return;
+    const size_t count = (size_t)frames * channels;
+    input.reserve(input.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        input.push_back(data[i] / 32768.0f);
+    }
+    process();
+}
+
+int AudioTimeStretcher::receiveSamples(int16_t* out, int maxFrames) {
+    int frames = std::min(maxFrames, getAvailableFrames());
+    const size_t count = (size_t)frames * channels;
+    std::copy(output.begin() + outputRead, output.begin() + outputRead + count, out);
+    outputRead += count;
+
+    // 已读部分积累较多时再整体前移
+    if (outputRead == output.size()) {
+        output.clear();
+        outputRead = 0;
+    } else if (outputRead > output.size() / 2) {
+        output.erase(output.begin(), output.begin() + outputRead);
+        outputRead = 0;
+    }
+    return frames;
+}
+
+double AudioTimeStretcher::getPendingInputFrames() const {
+    // 输入中上一片段自然延续之后的部分还没有输出，已输出未取走的部分按速度换算回输入时长
+    int64_t consumed = prevSegment >= 0 ? prevSegment + hop : inputStart;
+    return (double)std::max<int64_t>(inputEnd() - consumed, 0) + getAvailableFrames() * stretchRate;
+}
+
+void AudioTimeStretcher::flush() {
+    if (segment == 0) return;
+    // 上一片段的后半部分与它在输入中的自然延续叠加，窗函数相加为1，结果就是原始输入
+    int64_t from = prevSegment >= 0 ? prevSegment + hop : (int64_t)std::llround(analysisPos);
+    from = std::max(from, inputStart);
+    for (size_t i = (size_t)(from - inputStart) * channels; i < input.size(); ++i) {
+        appendOutput(input[i]);
+    }
+    input.clear();
+    inputStart = 0;
+    analysisPos = 0;
+    prevSegment = -1;
+    std::fill(overlap.begin(), overlap.end(), 0.0f);
+}
+
+void AudioTimeStretcher::process() {
+    for (;;) {
+        const int64_t nominal = std::max((int64_t)std::llround(analysisPos), inputStart);
+        const int64_t searchBegin = std::max(nominal - seekWindow, inputStart);
+        const int64_t searchEnd = nominal + seekWindow;
+        if (searchEnd + segment > inputEnd()) break;
+
+        const int64_t best = prevSegment >= 0 ? findBestSegment(searchBegin, searchEnd) : nominal;
+        const float* seg = &input[(size_t)(best - inputStart) * channels];
+
+        // 前半部分与上一片段的尾部叠加后输出，后半部分留到下一步
+        for (int n = 0; n < hop; ++n) {
+            for (int c = 0; c < channels; ++c) {
+                appendOutput(overlap[n * channels + c] + seg[n * channels + c] * window[n]);
+            }
+        }
+        for (int n = 0; n < hop; ++n) {
+            for (int c = 0; c < channels; ++c) {
+                overlap[n * channels + c] = seg[(hop + n) * channels + c] * window[hop + n];
+            }
+        }
+
+        prevSegment = best;
+        analysisPos += hop * stretchRate;
+
+        // 之后只会用到上一片段的自然延续和下一次的搜索范围
+        discardInput(std::min((int64_t)std::llround(analysisPos) - seekWindow, prevSegment + hop));
+    }
+}
+
+// 在[searchBegin, searchEnd]中找与上一片段自然延续(prevSegment + hop起的hop帧)归一化互相关最大的起点。
+// 先按4帧步长粗搜，再在最优点附近逐帧细搜，互相关只用单声道、隔一帧取样
+int64_t AudioTimeStretcher::findBestSegment(int64_t searchBegin, int64_t searchEnd) {
+    const int64_t target = prevSegment + hop;
+    const int searchFrames = (int)(searchEnd - searchBegin) + hop;
+
+    auto toMono = [this](int64_t from, int frames, std::vector<float>& mono) {
+        mono.resize(frames);
+        const float* src = &input[(size_t)(from - inputStart) * channels];
+        for (int i = 0; i < frames; ++i) {
+            float sum = 0;
+            for (int c = 0; c < channels; ++c) sum += src[i * channels + c];
+            mono[i] = sum;
+        }
+    };
+    toMono(target, hop, monoTarget);
+    toMono(searchBegin, searchFrames, monoSearch);
+
+    auto score = [this](int offset) {
+        const float* candidate = &monoSearch[offset];
+        float dot = 0, energy = 1e-6f;
+        for (int i = 0; i < hop; i += 2) {
+            dot += monoTarget[i] * candidate[i];
+            energy += candidate[i] * candidate[i];
+        }
+        return dot / sqrtf(energy);
+    };
+
+    const int range = (int)(searchEnd - searchBegin);
+    int bestOffset = 0;
+    float bestScore = -1e30f;
+    for (int offset = 0; offset <= range; offset += 4) {
+        float s = score(offset);
+        if (s > bestScore) {
+            bestScore = s;
+            bestOffset = offset;
+        }
+    }
+    const int fineBegin = std::max(0, bestOffset - 3);
+    const int fineEnd = std::min(range, bestOffset + 3);
+    for (int offset = fineBegin; offset <= fineEnd; ++offset) {
+        float s = score(offset);
+        if (s > bestScore) {
+            bestScore = s;
+            bestOffset = offset;
+        }
+    }
+    return searchBegin + bestOffset;
+}
+
+void AudioTimeStretcher::appendOutput(float value) {
+    float scaled = value * 32768.0f;
+    scaled = std::max(-32768.0f, std::min(32767.0f, scaled));
+    output.push_back((int16_t)lrintf(scaled));
+}
+
+void AudioTimeStretcher::discardInput(int64_t before) {
+    // 攒够一定数量再删除，避免每一步都移动整个缓冲区
+    if (before - inputStart < hop * 4) return;
+    input.erase(input.begin(), input.begin() + (size_t)(before - inputStart) * channels);
+    inputStart = before;
+}
@@ -0,0 +1,38 @@
+//
+// Created by Weichuandong on 2025/5/2.
+//
+
+#define LOG_TAG "DecoderFactory"
+
+#include "Decoder/DecoderFactory.h"
+#include "Decoder/FFmpegVideoDecoder.h"
+#include "platform/Platform.h"
+#include "platform/Log.h"
+
+std::unique_ptr<DecoderFactory> DecoderFactory::createDefault() {
+    std::vector<Candidate> candidates;
+
+    // 平台不支持硬解(桌面环境)时不加入硬解候选，选择记录中只有软解
+    auto capsList = getHardwareVideoDecoderCaps();
+    if (!capsList.empty()) {
+        candidates.push_back(hardwareCandidate("hardware", std::move(capsList),
+                [](const DecoderConfig& config, bool& needAnnexB) {
+                    return createHardwareVideoDecoder(config.param, needAnnexB);
+                }));
+    }
+
+    Candidate software;
+    software.name = "FFmpeg";
+    software.create = [](const DecoderConfig& config, bool& needAnnexB) -> std::unique_ptr<IVideoDecoder> {
+        needAnnexB = false;
+        auto decoder = std::make_unique<FFmpegVideoDecoder>();
+        if (!decoder->configure(config)) {
+            LOGE("failed to configure FFmpegVideoDecoder");
+            return nullptr;
+        }
+        return decoder;
+    };
+    candidates.push_back(std::move(software));
+
+    return std::make_unique<DecoderFactory>(std::move(candidates));
+}
@@ -1,7 +1,10 @@
 //
 // Created by Weichuandong on 2025/3/25.
 //
+#define LOG_TAG "FFmpegAudioDecoder"
+
 #include "Decoder/FFmpegAudioDecoder.h"
+#include "core/Trace.hpp"
 
 FFmpegAudioDecoder::FFmpegAudioDecoder() {
 
@@ -38,7 +41,7 @@ bool FFmpegAudioDecoder::configure(const DecoderConfig& codecParams) {
         return -1;
     }
 
-    inChannel = avCodecContext->channels;
+    inChannel = getChannelCount(avCodecContext);
     inSampleFormat = avCodecContext->sample_fmt;
     inSampleRate = avCodecContext->sample_rate;
 
@@ -49,6 +52,7 @@ bool FFmpegAudioDecoder::configure(const DecoderConfig& codecParams) {
 }
 
 int FFmpegAudioDecoder::SendPacket(const std::shared_ptr<IMediaPacket>& packet) {
+    TRACE_SCOPE("audio_send_packet");
     // 发送包到解码器'
     auto mediaPacket = packet->asAVPacket();
     int sendResult = avcodec_send_packet(avCodecContext, mediaPacket);
@@ -62,6 +66,7 @@ int FFmpegAudioDecoder::SendPacket(const std::shared_ptr<IMediaPacket>& packet)
 }
 
 int FFmpegAudioDecoder::ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) {
+    TRACE_SCOPE("audio_receive_frame");
     auto mediaFrame = frame->asAVFrame();
     int ret = avcodec_receive_frame(avCodecContext, mediaFrame);
 
@@ -75,6 +80,12 @@ int FFmpegAudioDecoder::ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) {
     return ret;
 }
 
+void FFmpegAudioDecoder::flush() {
+    if (avCodecContext) {
+        avcodec_flush_buffers(avCodecContext);
+    }
+}
+
 void FFmpegAudioDecoder::release() {
     if (avCodecContext) {
         avcodec_flush_buffers(avCodecContext);
@@ -2,14 +2,26 @@
 // Created by Weichuandong on 2025/3/17.
 //
 
+#define LOG_TAG "FFmpegVideoDecoder"
+
 #include "Decoder/FFmpegVideoDecoder.h"
+#include "core/Trace.hpp"
+#include "core/DecoderThreading.hpp"
+
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+
+extern "C" {
+#include "libavutil/time.h"
+}
 
 FFmpegVideoDecoder::FFmpegVideoDecoder() :
     avCodecContext(nullptr),
+    isReady(false),
     mWidth(0),
     mHeight(0),
-    format(AV_PIX_FMT_NONE),
-    isReady(false)
+    format(AV_PIX_FMT_NONE)
 {
 
 }
@@ -26,30 +38,27 @@ bool FFmpegVideoDecoder::configure(const DecoderConfig& codecParams) {
 
     auto param = codecParams.param;
     // 查找解码器
-    const AVCodec* codec = avcodec_find_decoder(param->codec_id);
+    codec = avcodec_find_decoder(param->codec_id);
     if (!codec) {
         LOGE("Could not find decoder : %d", param->codec_id);
         return false;
     }
+    config = codecParams;
 
-    // 分配解码器上下文
-    avCodecContext = avcodec_alloc_context3(codec);
-    if (!avCodecContext) {
-        LOGE("Could not alloc codecContext");
-        return false;
+    // 解码结果直接写入池中对齐的缓冲区，linesize满足纹理上传的要求，稳定播放时没有逐帧分配。
+    // parameters["frame_buffers"] = "default"时使用FFmpeg默认的分配方式
+    auto frameBuffers = config.parameters.find("frame_buffers");
+    if (frameBuffers == config.parameters.end() || frameBuffers->second != "default") {
+        bufferPool = std::make_unique<VideoBufferPool>();
     }
-    // 将参数复制到解码器上下文
-    if (avcodec_parameters_to_context(avCodecContext, param) < 0) {
-        LOGE("Could not parameters to codecContext");
-        return false;
-    }
-    avCodecContext->thread_count = 8;
+    // 降质的lowres一级只有支持低分辨率解码的解码器(MPEG-1/2/4、MJPEG等)可用
+    quality.setLowresAvailable(codec->max_lowres > 0);
 
-    // 打开解码器
-    if (avcodec_open2(avCodecContext, codec, nullptr) < 0) {
-        LOGE("Could not open decoder");
-        return -1;
+    avCodecContext = openContext(0);
+    if (!avCodecContext) {
+        return false;
     }
+    applyQuality();
 
     // 保存视频属性
     mWidth = avCodecContext->width;
@@ -57,27 +66,116 @@ bool FFmpegVideoDecoder::configure(const DecoderConfig& codecParams) {
     format = avCodecContext->pix_fmt;
     isReady = true;
 
-    LOGI("Video decoder configured: %dx%d, pixel format: %d", mWidth, mHeight, format);
+    auto latency = config.parameters.find("latency");
+    bool live = latency != config.parameters.end() && latency->second == "live";
+    LOGI("Video decoder configured: %dx%d, pixel format: %d, %d %s threads%s, %s frame buffers", mWidth, mHeight, format,
+         avCodecContext->thread_count, DecoderThreading::typeName(avCodecContext->active_thread_type),
+         live ? " (live)" : "", bufferPool && avCodecContext->opaque ? "pooled" : "default");
     return true;
 }
 
+AVCodecContext* FFmpegVideoDecoder::openContext(int lowres) {
+    auto param = config.param;
+    // 分配解码器上下文
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if (!ctx) {
+        LOGE("Could not alloc codecContext");
+        return nullptr;
+    }
+    // 将参数复制到解码器上下文
+    if (avcodec_parameters_to_context(ctx, param) < 0) {
+        LOGE("Could not parameters to codecContext");
+        avcodec_free_context(&ctx);
+        return nullptr;
+    }
+    // 多线程方式和线程数由DecoderThreading按核数、分辨率、解码器能力和延迟要求决定
+    // parameters["latency"]: "live"为低延迟，parameters["max_delay_frames"]为低延迟时允许的额外延迟(帧)
+    // parameters["threads"]/["thread_type"]("frame"/"slice")直接指定，threads为0表示由FFmpeg按CPU核数决定
+    auto latency = config.parameters.find("latency");
+    bool live = latency != config.parameters.end() && latency->second == "live";
+    auto input = DecoderThreading::describe(codec, param, (int)std::thread::hardware_concurrency(),
+                                            live ? DecoderThreading::Latency::LIVE : DecoderThreading::Latency::VOD);
+    auto maxDelay = config.parameters.find("max_delay_frames");
+    if (maxDelay != config.parameters.end()) {
+        input.maxDelayFrames = atoi(maxDelay->second.c_str());
+    }
+    auto threading = DecoderThreading::choose(input);
+
+    auto threads = config.parameters.find("threads");
+    if (threads != config.parameters.end()) {
+        threading.threadCount = std::max(0, atoi(threads->second.c_str()));
+        if (threading.threadType == 0) threading.threadType = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    }
+    auto threadType = config.parameters.find("thread_type");
+    if (threadType != config.parameters.end()) {
+        threading.threadType = threadType->second == "slice" ? FF_THREAD_SLICE : FF_THREAD_FRAME;
+    }
+    ctx->thread_count = threading.threadCount;
+    if (threading.threadType != 0) {
+        ctx->thread_type = threading.threadType;
+    }
+
+    if (bufferPool) {
+        VideoBufferPool::attach(ctx, bufferPool.get());
+    }
+    ctx->lowres = lowres;
+
+    // 打开解码器
+    if (avcodec_open2(ctx, codec, nullptr) < 0) {
+        LOGE("Could not open decoder");
+        avcodec_free_context(&ctx);
+        return nullptr;
+    }
+    return ctx;
+}
+
 int FFmpegVideoDecoder::SendPacket(const std::shared_ptr<IMediaPacket>& packet) {
+    TRACE_SCOPE("video_send_packet");
+    if (!avCodecContext) {
+        return AVERROR(EINVAL);
+    }
     // 发送包到解码器
     auto avPacket = packet->asAVPacket();
+
+    // lowres只能在重新打开解码器时改变，在关键帧处切换，之后的帧不会引用切换前的参考帧。
+    // 旧解码器中还没有输出的帧(帧级多线程时最多线程数 - 1帧)被丢弃。新解码器打开失败时继续使用旧的
+    const int lowres = wantedLowres();
+    if (avPacket && (avPacket->flags & AV_PKT_FLAG_KEY) && lowres != avCodecContext->lowres) {
+        AVCodecContext* ctx = openContext(lowres);
+        if (ctx) {
+            avcodec_free_context(&avCodecContext);
+            avCodecContext = ctx;
+            applyQuality();
+            LOGI("decoder reopened with lowres %d", lowres);
+        } else {
+            LOGE("failed to reopen decoder with lowres %d, keep lowres %d", lowres, avCodecContext->lowres);
+        }
+    }
+
+    int64_t begin = av_gettime_relative();
     int sendResult = avcodec_send_packet(avCodecContext, avPacket);
     if (sendResult < 0) {
         char errString[128];
         av_strerror(sendResult, errString, 128);
         LOGE("avcodec_send_packet failed due to '%s'", errString);
     }
+    // 空包(流结束)和调用方要求跳帧时的packet不计入负载，跳过的帧几乎不耗时，会让负载看起来偏低
+    packetDecodeUs = av_gettime_relative() - begin;
+    packetPending = avPacket != nullptr && externalDiscard == AVDISCARD_DEFAULT;
 
     return sendResult;
 }
 
 int FFmpegVideoDecoder::ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) {
+    TRACE_SCOPE("video_receive_frame");
+    if (!avCodecContext) {
+        return AVERROR(EINVAL);
+    }
     auto avFrame = frame->asAVFrame();
 
+    int64_t begin = av_gettime_relative();
     int ret = avcodec_receive_frame(avCodecContext, avFrame);
+    packetDecodeUs += av_gettime_relative() - begin;
 
     if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
 
@@ -86,18 +184,78 @@ int FFmpegVideoDecoder::ReceiveFrame(std::shared_ptr<IMediaFrame>& frame) {
         av_strerror(ret, errString, 128);
         LOGE("avcodec_receive_frame failed due to '%s'", errString);
     }
+
+    // 取空之后这个packet的解码耗时才完整
+    if (ret != 0 && packetPending) {
+        packetPending = false;
+        const int64_t interval = frameIntervalUs.load(std::memory_order_relaxed);
+        if (quality.onPacket(packetDecodeUs, interval, av_gettime_relative())) {
+            applyQuality();
+        }
+    }
     return ret;
 }
 
+void FFmpegVideoDecoder::flush() {
+    if (avCodecContext) {
+        avcodec_flush_buffers(avCodecContext);
+    }
+    packetPending = false;
+    quality.resetLoad();
+}
+
+void FFmpegVideoDecoder::setFrameDiscard(AVDiscard discard) {
+    // 跳帧期间和之后的负载不可比，重新累计
+    if (discard != externalDiscard) {
+        packetPending = false;
+        quality.resetLoad();
+    }
+    externalDiscard = discard;
+    applyQuality();
+}
+
+void FFmpegVideoDecoder::setFrameInterval(double seconds) {
+    frameIntervalUs.store(seconds > 0 ? (int64_t)(seconds * 1000000) : 0, std::memory_order_relaxed);
+}
+
+int FFmpegVideoDecoder::wantedLowres() const {
+    return quality.getLevel() >= DecodeQualityController::Level::LOWRES && codec && codec->max_lowres > 0 ? 1 : 0;
+}
+
+void FFmpegVideoDecoder::applyQuality() {
+    if (!avCodecContext) return;
+    const auto level = quality.getLevel();
+    AVDiscard loopFilter = AVDISCARD_DEFAULT;
+    if (level >= DecodeQualityController::Level::SKIP_LOOP_FILTER_ALL) {
+        loopFilter = AVDISCARD_ALL;
+    } else if (level == DecodeQualityController::Level::SKIP_LOOP_FILTER_NONREF) {
+        loopFilter = AVDISCARD_NONREF;
+    }
+    avCodecContext->skip_loop_filter = loopFilter;
+    // 调用方(seek、倍速、渲染落后)要求的跳帧与降质的跳帧取较强的一个
+    AVDiscard discard = level == DecodeQualityController::Level::SKIP_NONREF ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    avCodecContext->skip_frame = std::max(externalDiscard, discard);
+}
+
 void FFmpegVideoDecoder::release() {
     if (avCodecContext) {
         avcodec_flush_buffers(avCodecContext);
         avcodec_free_context(&avCodecContext);
     }
+    if (bufferPool && bufferPool->getRequestCount() > 0) {
+        LOGI("frame buffer pool: %llu frames decoded into %llu buffers of %zuKB",
+             (unsigned long long)bufferPool->getRequestCount(), (unsigned long long)bufferPool->getAllocCount(),
+             bufferPool->getBufferSize() / 1024);
+    }
+    // 帧队列中的帧仍然引用池中的缓冲区时，池在它们释放之后才真正回收
+    bufferPool.reset();
     isReady = false;
 }
 
 PixFormat FFmpegVideoDecoder::getPixFormat() {
+    if (!avCodecContext) {
+        return PixFormat::UNKNOWN;
+    }
     switch (avCodecContext->pix_fmt) {
         case AV_PIX_FMT_YUV420P:
             return PixFormat::YUV420P;
@@ -2,6 +2,8 @@
 // Created by Weichuandong on 2025/4/3.
 //
 
+#define LOG_TAG "MediaCodecDecoderWrapper"
+
 #include "Decoder/MediaCodecDecoderWrapper.h"
 
 
@@ -198,6 +200,18 @@ bool MediaCodecDecoderWrapper::releaseOutputBuffer(int outputBufferId) {
     return false;
 }
 
+bool MediaCodecDecoderWrapper::flush() {
+    if (!decoderObject) {
+        LOGE("decoderObject is null, maybe initJNI failed");
+        return false;
+    }
+    JNIEnv *env = getEnv();
+    if (env && flushMethod) {
+        return env->CallBooleanMethod(decoderObject, flushMethod);
+    }
+    return false;
+}
+
 bool MediaCodecDecoderWrapper::initJNI() {
     // 获取JavaVM
     if (g_jvm == nullptr) {
@@ -255,6 +269,8 @@ bool MediaCodecDecoderWrapper::initJNI() {
                                                     "()V");
     releaseMethod = env->GetMethodID(localDecoderRef, "release",
                                      "()V");
+    flushMethod = env->GetMethodID(localDecoderRef, "flush",
+                                   "()Z");
 
     // 查找DecodedFrame类
     jclass localFrameRef = env->FindClass("com/example/glmediakit/decoder/DecodedFrame");
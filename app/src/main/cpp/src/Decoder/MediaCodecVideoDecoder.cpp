@@ -2,7 +2,11 @@
 // Created by Weichuandong on 2025/4/8.
 //
 
+#define LOG_TAG "C++_MediaCodecVideoDecoder"
+
 #include "Decoder/MediaCodecVideoDecoder.h"
+#include "core/Trace.hpp"
+#include "core/DeferredLog.hpp"
 
 MediaCodecVideoDecoder::MediaCodecVideoDecoder() :
     mediaCodecDecoderWrapper(std::make_unique<MediaCodecDecoderWrapper>()),
@@ -14,10 +18,12 @@ MediaCodecVideoDecoder::MediaCodecVideoDecoder() :
 }
 
 int MediaCodecVideoDecoder::SendPacket(const std::shared_ptr<IMediaPacket> &packet) {
+    TRACE_SCOPE("video_send_packet");
     // packet中的数据
-    if (!packet) {
+    if (!packet || !packet->asAVPacket()) {
+        // 流结束的空包，MediaCodec侧暂不支持drain
         LOGE("packet is null");
-        return false;
+        return -1;
     }
 
     const uint8_t* data = packet->getData();
@@ -36,7 +42,7 @@ int MediaCodecVideoDecoder::SendPacket(const std::shared_ptr<IMediaPacket> &pack
 //        AnnexBData = convertAVCCToAnnexB(AVCCData);
 //    }
 
-    LOGI("SendPacket params : size = %d, ts = %ld", size, packet->getPts());
+    LOGD_DEFERRED("SendPacket params : size = %d, ts = %lld", size, packet->getPts());
     if (mediaCodecDecoderWrapper->pushEncodedData(data, size, packet->getPts(), 0)) {
         return 0;
     } else {
@@ -45,6 +51,7 @@ int MediaCodecVideoDecoder::SendPacket(const std::shared_ptr<IMediaPacket> &pack
 }
 
 int MediaCodecVideoDecoder::ReceiveFrame(std::shared_ptr<IMediaFrame> &frame) {
+    TRACE_SCOPE("video_receive_frame");
     std::vector<uint8_t> data;
     size_t dataSize;
     int64_t pts;
@@ -63,26 +70,36 @@ int MediaCodecVideoDecoder::ReceiveFrame(std::shared_ptr<IMediaFrame> &frame) {
     return -1;
 }
 
+void MediaCodecVideoDecoder::flush() {
+    if (!mediaCodecDecoderWrapper->flush()) {
+        LOGE("flush MediaCodec failed");
+    }
+}
+
 bool MediaCodecVideoDecoder::isReadying() {
     return ready;
 }
 
 bool MediaCodecVideoDecoder::configure(const DecoderConfig &config) {
     decoderConfig = config;
-    // 调用wrapper的init方法
-    // 根据config获取参数
-    if (decoderConfig.extraData.find("sps") == decoderConfig.extraData.end() ||
-            decoderConfig.extraData.find("pps") == decoderConfig.extraData.end()) {
-        LOGE("config not have sps and pps");
+    // extraData中的"csd-0"/"csd-1"对应MediaFormat的同名字段:
+    // H.264为SPS/PPS，HEVC的VPS/SPS/PPS合在一起作为csd-0，VP9不需要，AV1为av1C(可选)
+    if (decoderConfig.type.empty()) {
+        LOGE("config not have mime type");
         return false;
     }
     mWidth = decoderConfig.width;
     mHeight = decoderConfig.height;
     format = decoderConfig.format;
-    const auto& sps = decoderConfig.extraData.at("sps");
-    const auto& pps = decoderConfig.extraData.at("pps");
+    auto csd = [&](const char* key) -> const std::vector<uint8_t>* {
+        auto it = decoderConfig.extraData.find(key);
+        return it != decoderConfig.extraData.end() && !it->second.empty() ? &it->second : nullptr;
+    };
+    const auto* csd0 = csd("csd-0");
+    const auto* csd1 = csd("csd-1");
     return mediaCodecDecoderWrapper->init(decoderConfig.type, mWidth, mHeight,
-                                   sps.data(), sps.size(), pps.data(), pps.size());
+                                          csd0 ? csd0->data() : nullptr, csd0 ? (int)csd0->size() : 0,
+                                          csd1 ? csd1->data() : nullptr, csd1 ? (int)csd1->size() : 0);
 
 }
 
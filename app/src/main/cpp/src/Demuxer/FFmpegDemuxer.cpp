@@ -2,21 +2,23 @@
 // Created by Weichuandong on 2025/3/20.
 //
 
+#define LOG_TAG "FFmpegDemuxer"
+
 #include "Demuxer/FFmpegDemuxer.h"
 
 #include <utility>
 
-FFmpegDemuxer::FFmpegDemuxer(FFmpegDemuxer::DemuxerType type) :
+FFmpegDemuxer::FFmpegDemuxer() :
         fmt_ctx(nullptr),
-        streamIdx(-1),
-        type(type),
+        audioStreamIdx(-1),
+        videoStreamIdx(-1),
         duration(0)
 {
 
 }
 
 FFmpegDemuxer::~FFmpegDemuxer() {
-
+    release();
 }
 
 bool FFmpegDemuxer::open(const std::string &file_path) {
@@ -26,6 +28,8 @@ bool FFmpegDemuxer::open(const std::string &file_path) {
         avformat_close_input(&fmt_ctx);
         fmt_ctx = nullptr;
     }
+    audioStreamIdx = videoStreamIdx = -1;
+    isReady = false;
 
     // 打开文件
     int ret = avformat_open_input(&fmt_ctx, file_path.c_str(), nullptr, nullptr);
@@ -47,17 +51,16 @@ bool FFmpegDemuxer::open(const std::string &file_path) {
         return false;
     }
 
-    // 寻找音频 或 视频流
-    for (int i = 0; i < fmt_ctx->nb_streams; ++i) {
-        AVStream* stream = fmt_ctx->streams[i];
-        if (type == DemuxerType::AUDIO && stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
-            LOGI("Audio streamIdx = %d", i);
-            streamIdx = i;
-            break;
-        } else if ( type == DemuxerType::VIDEO && stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-            LOGI("Video streamIdx = %d", i);
-            streamIdx = i;
-            break;
+    // 同一个上下文中同时寻找音频流和视频流
+    videoStreamIdx = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    audioStreamIdx = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_AUDIO, -1, videoStreamIdx, nullptr, 0);
+    if (videoStreamIdx < 0) videoStreamIdx = -1;
+    if (audioStreamIdx < 0) audioStreamIdx = -1;
+
+    // 其余流的数据直接在解封装层丢弃，不参与读取
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; ++i) {
+        if ((int)i != audioStreamIdx && (int)i != videoStreamIdx) {
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
         }
     }
 
@@ -69,59 +72,79 @@ bool FFmpegDemuxer::open(const std::string &file_path) {
     // 打印一些调试信息
     LOGI("Media opened: %s", filePath.c_str());
     LOGI("Duration: %.2f seconds", duration);
-    if (type == DemuxerType::AUDIO) LOGI("Has audio: %s", hasAudio() ? "yes" : "no");
-    if (type == DemuxerType::VIDEO) LOGI("Has video: %s", hasVideo() ? "yes" : "no");
+    LOGI("Audio streamIdx = %d, Video streamIdx = %d", audioStreamIdx, videoStreamIdx);
+
+    isReady = hasAudio() || hasVideo();
+    return isReady;
+}
+
+bool FFmpegDemuxer::seekTo(double position) {
+    if (!fmt_ctx) return false;
+
+    int64_t ts = (int64_t)(position * AV_TIME_BASE);
+    if (fmt_ctx->start_time != AV_NOPTS_VALUE) {
+        ts += fmt_ctx->start_time;
+    }
+    // max_ts = ts: 落在目标位置之前(或等于)的关键帧上，保证目标帧可以解码出来
+    int ret = avformat_seek_file(fmt_ctx, -1, INT64_MIN, ts, ts, 0);
+    if (ret < 0) {
+        char errString[128];
+        av_strerror(ret, errString, 128);
+        LOGE("seek to %.3f failed due to '%s'", position, errString);
+        return false;
+    }
+    LOGI("seek to %.3f", position);
+    return true;
+}
+
+double FFmpegDemuxer::getStartTime() const {
+    if (!fmt_ctx || fmt_ctx->start_time == AV_NOPTS_VALUE) return 0;
+    return fmt_ctx->start_time / (double)AV_TIME_BASE;
+}
 
-    return streamIdx >= 0;
+AVCodecParameters* FFmpegDemuxer::getAudioCodecParameters() const {
+    if (!fmt_ctx || audioStreamIdx < 0) return nullptr;
+    return fmt_ctx->streams[audioStreamIdx]->codecpar;
 }
 
-void FFmpegDemuxer::seekTo(double position) {
-    isSeekRequested = true;
-    seekPosition = position;
+AVCodecParameters* FFmpegDemuxer::getVideoCodecParameters() const {
+    if (!fmt_ctx || videoStreamIdx < 0) return nullptr;
+    return fmt_ctx->streams[videoStreamIdx]->codecpar;
 }
 
-AVCodecParameters* FFmpegDemuxer::getCodecParameters() {
-    if (!fmt_ctx || streamIdx < 0) return nullptr;
-    return fmt_ctx->streams[streamIdx]->codecpar;
+AVStream* FFmpegDemuxer::getVideoStream() const {
+    if (!fmt_ctx || videoStreamIdx < 0) return nullptr;
+    return fmt_ctx->streams[videoStreamIdx];
 }
 
 bool FFmpegDemuxer::hasVideo() const {
-    return type == DemuxerType::VIDEO && streamIdx >= 0;
+    return videoStreamIdx >= 0;
 }
 
 bool FFmpegDemuxer::hasAudio() const {
-    return type == DemuxerType::AUDIO && streamIdx >= 0;
+    return audioStreamIdx >= 0;
 }
 
-AVRational FFmpegDemuxer::getTimeBase() const {
-    if (streamIdx >= 0 && fmt_ctx && fmt_ctx->streams[streamIdx]) {
-        LOGI("TimeBase = {%d, %d}",
-             fmt_ctx->streams[streamIdx]->time_base.num,
-             fmt_ctx->streams[streamIdx]->time_base.den);
-        return fmt_ctx->streams[streamIdx]->time_base;
+AVRational FFmpegDemuxer::getAudioTimeBase() const {
+    if (audioStreamIdx >= 0 && fmt_ctx && fmt_ctx->streams[audioStreamIdx]) {
+        return fmt_ctx->streams[audioStreamIdx]->time_base;
+    }
+    return AVRational{0, 0};
+}
+
+AVRational FFmpegDemuxer::getVideoTimeBase() const {
+    if (videoStreamIdx >= 0 && fmt_ctx && fmt_ctx->streams[videoStreamIdx]) {
+        return fmt_ctx->streams[videoStreamIdx]->time_base;
     }
     return AVRational{0, 0};
 }
 
 int FFmpegDemuxer::ReceivePacket(AVPacket *packet) {
-    int ret;
-    while (true) {
-        ret = av_read_frame(fmt_ctx, packet);
-        if (ret >= 0) {
-            if (packet->stream_index == streamIdx) {
-                // 获取对应流packet
-                break;
-            } else {
-                av_packet_unref(packet);
-                continue;
-            }
-        } else if (ret == AVERROR_EOF) {
-
-        } else {
-            char errString[128];
-            av_strerror(ret, errString, 128);
-            LOGE("av_read_frame failed due to '%s'", errString);
-        }
+    int ret = av_read_frame(fmt_ctx, packet);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        char errString[128];
+        av_strerror(ret, errString, 128);
+        LOGE("av_read_frame failed due to '%s'", errString);
     }
 
     return ret;
@@ -129,6 +152,8 @@ int FFmpegDemuxer::ReceivePacket(AVPacket *packet) {
 
 void FFmpegDemuxer::release() {
     if (fmt_ctx) {
-        avformat_free_context(fmt_ctx);
+        avformat_close_input(&fmt_ctx);
+        fmt_ctx = nullptr;
     }
-}
\ No newline at end of file
+    isReady = false;
+}
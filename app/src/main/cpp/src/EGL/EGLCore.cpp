@@ -2,6 +2,8 @@
 // Created by Weichuandong on 2025/3/10.
 //
 
+#define LOG_TAG "EGLCore"
+
 #include "EGL/EGLCore.h"
 
 EGLCore::EGLCore()
@@ -60,13 +62,13 @@ bool EGLCore::init() {
     return true;
 }
 
-EGLSurface EGLCore::createWindowSurface(ANativeWindow *window) {
+EGLSurface EGLCore::createWindowSurface(NativeWindow *window) {
     if (window == nullptr) {
         LOGE("window is null");
         return EGL_NO_SURFACE;
     }
     mWindow = window;
-    eglSurface = eglCreateWindowSurface(eglDisplay, eglConfig, window, NULL);
+    eglSurface = eglCreateWindowSurface(eglDisplay, eglConfig, reinterpret_cast<EGLNativeWindowType>(window), NULL);
     if (eglSurface == EGL_NO_SURFACE) {
         LOGE("Unable to create EGL surface");
     }
@@ -107,7 +109,7 @@ void EGLCore::destroySurface() {
 
     // 释放窗口
     if (mWindow) {
-        ANativeWindow_release(mWindow);
+        releaseNativeWindow(mWindow);
         mWindow = nullptr;
     }
 }
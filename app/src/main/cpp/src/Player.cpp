@@ -2,21 +2,40 @@
 // Created by Weichuandong on 2025/3/19.
 //
 
+#define LOG_TAG "Player"
+
 #include "Player.h"
+#include "core/Trace.hpp"
 
 Player::Player():
-    videoFrameQueue(std::make_shared<SafeQueue<AVFrame*>>(3)),
-    audioFrameQueue(std::make_unique<SafeQueue<AVFrame*>>(10)),
-    synchronizer(std::make_shared<MediaSynchronizer>(MediaSynchronizer::SyncSource::AUDIO)),
     eglCore(std::make_unique<EGLCore>()),
     renderer(std::make_unique<VideoRenderer>()),
+    synchronizer(std::make_shared<MediaSynchronizer>(MediaSynchronizer::SyncSource::AUDIO)),
+    playbackStats(std::make_shared<PlaybackStats>()),
+    framePacing(std::make_shared<FramePacing>()),
+    lateFrameController(std::make_shared<LateFrameController>()),
     currentState(PlayerState::INIT),
     previousState(PlayerState::INIT),
-    isAttachSurface(false)
+    isAttachSurface(false),
+    // 初始大小与原来一致，运行时由FFmpegReader按缓冲时长和内存上限在上限以内调整
+    videoFrameQueue(std::make_shared<SPSCQueue<AVFrame*>>(3, 32)),
+    audioFrameQueue(std::make_shared<SPSCQueue<AVFrame*>>(10, 128)),
+    // 池容量覆盖队列的最大容量以及生产者、消费者各自持有的一帧
+    videoFramePool(std::make_shared<FramePool>(34)),
+    audioFramePool(std::make_shared<FramePool>(130))
 {
-    audioPlayer = std::make_unique<SLAudioPlayer>(audioFrameQueue, synchronizer);
-    renderThread = std::make_unique<RenderThread>(videoFrameQueue,synchronizer),
-    reader = std::make_unique<FFmpegReader>(videoFrameQueue, audioFrameQueue),
+    // seek、切换文件时被flush的帧回到池中，之后解码不需要重新分配
+    videoFrameQueue->setRecycler([pool = videoFramePool](AVFrame* frame) { pool->release(frame); });
+    audioFrameQueue->setRecycler([pool = audioFramePool](AVFrame* frame) { pool->release(frame); });
+    audioPlayer = createAudioSink(audioFrameQueue, audioFramePool, synchronizer);
+    renderThread = std::make_unique<RenderThread>(videoFrameQueue, videoFramePool, synchronizer),
+    reader = std::make_unique<FFmpegReader>(videoFrameQueue, audioFrameQueue, videoFramePool, audioFramePool),
+    renderThread->setStats(playbackStats);
+    renderThread->setFramePacing(framePacing);
+    renderThread->setLateFrameController(lateFrameController);
+    reader->setStats(playbackStats);
+    reader->setLateFrameController(lateFrameController);
+    reader->setErrorCallback([this](int error) { onReaderError(error); });
 
     init();
 }
@@ -101,9 +120,10 @@ bool Player::stop() {
 }
 
 
-bool Player::seekTo(double position) {
+bool Player::seekTo(double position, FFmpegReader::SeekMode mode) {
     LOGI("Player seekTo : %f", position);
     seekPosition = position;
+    seekMode = mode;
     if (!canTransitionTo(PlayerState::SEEKING)) {
         return false;
     }
@@ -111,11 +131,64 @@ bool Player::seekTo(double position) {
     return true;
 }
 
+bool Player::beginScrub() {
+    std::lock_guard<std::mutex> lk(stateMtx);
+    if (isScrubbing || !reader ||
+        (currentState != PlayerState::PLAYING && currentState != PlayerState::PAUSED)) {
+        return false;
+    }
+    LOGI("Player begin scrub");
+    isScrubbing = true;
+
+    if (audioPlayer) audioPlayer->pause();
+    // 没有声音，画面按视频时钟推进
+    synchronizer->setMaster(MediaSynchronizer::SyncSource::VIDEO);
+    // 暂停状态下也需要把拖动位置的画面显示出来
+    reader->setScrubbing(true);
+    reader->resume();
+    if (renderThread) renderThread->resume();
+    return true;
+}
+
+bool Player::scrubTo(double position) {
+    std::lock_guard<std::mutex> lk(stateMtx);
+    if (!isScrubbing) return false;
+
+    // reader只处理最后一次请求，连续调用时中间的目标会被合并
+    scrubPosition = position;
+    int serial = reader->seekTo(position, FFmpegReader::SeekMode::KEYFRAME);
+    synchronizer->reset(position + reader->getStartTime());
+    synchronizer->setSerial(serial);
+    return true;
+}
+
+bool Player::endScrub() {
+    std::lock_guard<std::mutex> lk(stateMtx);
+    if (!isScrubbing) return false;
+    LOGI("Player end scrub at %f", scrubPosition);
+    isScrubbing = false;
+
+    // 从拖动结束的位置精确seek，恢复正常解码
+    reader->setScrubbing(false);
+    int serial = reader->seekTo(scrubPosition, FFmpegReader::SeekMode::ACCURATE);
+    synchronizer->reset(scrubPosition + reader->getStartTime());
+    synchronizer->setSerial(serial);
+    synchronizer->setMaster(syncMaster);
+
+    if (currentState == PlayerState::PLAYING) {
+        if (audioPlayer && hasAudioOutput) audioPlayer->resume();
+    } else {
+        reader->pause();
+        if (renderThread) renderThread->pause();
+    }
+    return true;
+}
+
 Player::PlayerState Player::getPlayerState() {
     return currentState;
 }
 
-void Player::attachSurface(ANativeWindow* window) {
+void Player::attachSurface(NativeWindow* window) {
     LOGI("Player attach to a surface");
     if (eglCore->createWindowSurface(window)) {
         std::lock_guard<std::mutex> lk(attachSurfaceMtx);
@@ -293,10 +366,23 @@ void Player::startMediaLoading() {
 //        LOGI("after flush, videoFrameQueue->getSize() = %d, audioFrameQueue->getSize() = %d",
 //             videoFrameQueue->getSize(), audioFrameQueue->getSize());
         LOGI("reset reader");
-        // 重置reader
+        // 重置reader: 先停止旧reader的线程，再在锁内替换，getter不会访问已经释放的reader
         reader->stop();
-        reader.reset();
-        reader = std::make_unique<FFmpegReader>(videoFrameQueue, audioFrameQueue);
+        auto newReader = std::make_unique<FFmpegReader>(videoFrameQueue, audioFrameQueue, videoFramePool, audioFramePool);
+        newReader->setStats(playbackStats);
+        newReader->setLateFrameController(lateFrameController);
+        newReader->setErrorCallback([this](int error) { onReaderError(error); });
+        std::unique_ptr<FFmpegReader> oldReader;
+        {
+            // 统计随reader一起清零，getter不会拿到新旧文件混合的数据
+            std::lock_guard<std::mutex> lk(readerMtx);
+            oldReader = std::move(reader);
+            reader = std::move(newReader);
+            playbackStats->reset();
+            framePacing->reset();
+        }
+        oldReader.reset();
+        lateFrameController->reset();
 
         LOGI("reset synchronizer");
         // 重置synchronizer
@@ -311,28 +397,47 @@ void Player::startMediaLoading() {
         // 重置audioPlayer
         audioPlayer->stop();
         audioPlayer.reset();
-        audioPlayer = std::make_unique<SLAudioPlayer>(audioFrameQueue, synchronizer);
+        audioPlayer = createAudioSink(audioFrameQueue, audioFramePool, synchronizer);
+
+        // 切换文件保持当前播放速度
+        synchronizer->setPlaybackRate(playbackRate);
+        audioPlayer->setPlaybackRate(playbackRate);
+        reader->setPlaybackRate(playbackRate);
     }
 
     LOGI("reader open");
     reader->open(mediaPath);
     renderThread->setTimeBase(reader->getVideoTimeBase());
-    audioPlayer->setTimeBase(reader->getAudioTimeBase());
 
-    LOGI("audioPlayer prepare");
-    if (!audioPlayer->prepare(reader->getSampleRate(),
-                              reader->getChannel(),
-                              static_cast<AVSampleFormat>(reader->getSampleFormat()))) {
-        LOGE("audioPlayer prepare failed");
+    hasAudioOutput = false;
+    if (reader->hasAudio()) {
+        LOGI("audioPlayer prepare");
+        audioPlayer->setTimeBase(reader->getAudioTimeBase());
+        hasAudioOutput = audioPlayer->prepare(reader->getSampleRate(),
+                                              reader->getChannel(),
+                                              static_cast<AVSampleFormat>(reader->getSampleFormat()));
+        if (!hasAudioOutput) {
+            LOGE("audioPlayer prepare failed");
+        }
     }
+
+    // 没有音频输出时音频时钟不会走动，改用外部时钟。开始播放之前时钟停在起点
+    // 时钟与帧的pts * time_base同一基准，起点是容器的start_time而不是0
+    syncMaster = MediaSynchronizer::selectMaster(hasAudioOutput);
+    synchronizer->reset(reader->getStartTime());
+    synchronizer->setMaster(syncMaster);
+    synchronizer->pause();
+    LOGI("audio: %d, video: %d, master clock: %s", reader->hasAudio(), reader->hasVideo(),
+         MediaSynchronizer::getSourceName(syncMaster));
 }
 
 void Player::startPlayback() {
-    if (previousState == PlayerState::PAUSED) {
-        // 暂停后重新播放
+    synchronizer->resume();
+    if (previousState == PlayerState::PAUSED || previousState == PlayerState::SEEKING) {
+        // 暂停或seek后继续播放
         if (reader) reader->resume();
         if (renderThread) renderThread->resume();
-        if (audioPlayer) audioPlayer->resume();
+        if (audioPlayer && hasAudioOutput) audioPlayer->resume();
     } else {
         // 初次播放
         // 启动解封装线程
@@ -347,7 +452,7 @@ void Player::startPlayback() {
             renderThread->resume();
         }
 
-        if (audioPlayer) {
+        if (audioPlayer && hasAudioOutput) {
             audioPlayer->start();
         }
     }
@@ -355,6 +460,7 @@ void Player::startPlayback() {
 
 void Player::pausePlayback() {
     LOGI("Player pause playback");
+    synchronizer->pause();
     if (reader) {
         reader->pause();
     }
@@ -369,9 +475,11 @@ void Player::pausePlayback() {
 }
 
 void Player::performSeeking() {
-    pausePlayback();
-
-    reader->seekTo(seekPosition);
+    // 不停止管线: reader在解封装线程中执行seek，旧数据按序号在各环节丢弃
+    // seekPosition从文件起点算起，时钟要加上start_time才能和帧的pts比较
+    int serial = reader->seekTo(seekPosition, seekMode);
+    synchronizer->reset(seekPosition + reader->getStartTime());
+    synchronizer->setSerial(serial);
 
     if (previousState == PlayerState::PLAYING) {
         changeState(PlayerState::PLAYING);
@@ -386,6 +494,22 @@ void Player::handleCompletion() {
 
 void Player::handleError() {
     LOGE("error");
+    // 数据源已经不可用，停止时钟和输出，等待调用方stop或重新设置数据源
+    synchronizer->pause();
+    if (audioPlayer) {
+        audioPlayer->pause();
+    }
+    if (renderThread) {
+        renderThread->pause();
+    }
+}
+
+void Player::onReaderError(int error) {
+    // 在解封装线程中回调，不访问reader
+    LOGE("reader failed to read media: %d", error);
+    if (canTransitionTo(PlayerState::ERROR)) {
+        changeState(PlayerState::ERROR);
+    }
 }
 
 void Player::releaseResources() {
@@ -397,6 +521,7 @@ void Player::releaseResources() {
 
     if (reader) {
         reader->stop();
+        std::lock_guard<std::mutex> lk(readerMtx);
         reader.reset();
     }
 
@@ -410,17 +535,91 @@ void Player::releaseResources() {
 }
 
 double Player::getDuration() const {
-    return reader->getDuration();
+    std::lock_guard<std::mutex> lk(readerMtx);
+    return reader ? reader->getDuration() : 0;
 }
 
 bool Player::isPlaying() const {
     return currentState == PlayerState::PLAYING;
 }
 
+double Player::getLastSeekLatencyMs() const {
+    std::lock_guard<std::mutex> lk(readerMtx);
+    return reader ? reader->getLastSeekLatencyMs() : 0;
+}
+
+bool Player::setPlaybackRate(float rate) {
+    if (rate < 0.25f || rate > 4.0f) {
+        LOGE("unsupported playback rate %.2f", rate);
+        return false;
+    }
+    LOGI("playback rate %.2f -> %.2f", playbackRate, rate);
+    playbackRate = rate;
+    synchronizer->setPlaybackRate(rate);
+    if (audioPlayer) audioPlayer->setPlaybackRate(rate);
+    std::lock_guard<std::mutex> lk(readerMtx);
+    if (reader) reader->setPlaybackRate(rate);
+    return true;
+}
+
+PlaybackStats::Snapshot Player::getStats() const {
+    PlaybackStats::Snapshot stats = playbackStats->snapshot();
+    stats.videoFrameQueueSize = videoFrameQueue->getSize();
+    stats.audioFrameQueueSize = audioFrameQueue->getSize();
+    stats.videoDecodeLevel = static_cast<int>(lateFrameController->getDecodeLevel());
+    std::lock_guard<std::mutex> lk(readerMtx);
+    if (reader && reader->isReadying()) {
+        BufferLevel videoLevel = reader->getVideoBufferLevel();
+        BufferLevel audioLevel = reader->getAudioBufferLevel();
+        stats.videoPacketQueuePackets = videoLevel.packets;
+        stats.videoPacketQueueBytes = videoLevel.bytes;
+        stats.audioPacketQueuePackets = audioLevel.packets;
+        stats.audioPacketQueueBytes = audioLevel.bytes;
+    }
+    return stats;
+}
+
+FramePacing::Report Player::getPacingReport() const {
+    std::lock_guard<std::mutex> lk(readerMtx);
+    return framePacing->report();
+}
+
+void Player::setDisplayRefreshRate(double hz) {
+    LOGI("display refresh rate = %.2fHz", hz);
+    framePacing->setRefreshRate(hz);
+    if (renderThread) renderThread->setRefreshRate(hz);
+}
+
+bool Player::startTrace() {
+    if (!GLMEDIAKIT_TRACE_ENABLED) {
+        LOGE("trace is not compiled in, rebuild with -DGLMEDIAKIT_TRACE=ON");
+        return false;
+    }
+    Trace::start();
+    return true;
+}
+
+bool Player::stopTrace(const std::string& path) {
+    Trace::stop();
+    if (!Trace::dumpChromeJson(path)) {
+        LOGE("failed to dump trace to %s", path.c_str());
+        return false;
+    }
+    LOGI("trace saved to %s", path.c_str());
+    return true;
+}
+
+std::string Player::getVideoDecoderInfo() const {
+    std::lock_guard<std::mutex> lk(readerMtx);
+    return reader ? reader->getVideoDecoderSelection().describe() : "none";
+}
+
 int Player::getVideoWidth() const {
-    return reader->getVideoWidth();
+    std::lock_guard<std::mutex> lk(readerMtx);
+    return reader ? reader->getVideoWidth() : 0;
 }
 
 int Player::getVideoHeight() const {
-    return reader->getVideoHeight();
+    std::lock_guard<std::mutex> lk(readerMtx);
+    return reader ? reader->getVideoHeight() : 0;
 }
\ No newline at end of file
@@ -2,25 +2,42 @@
 // Created by Weichuandong on 2025/3/28.
 //
 
+#define LOG_TAG "FFmpegReader"
+
 #include "Reader/FFmpegReader.h"
+#include "core/Trace.hpp"
+
+#include <algorithm>
+
+extern "C" {
+#include "libavutil/imgutils.h"
+};
 
-FFmpegReader::FFmpegReader(std::shared_ptr<SafeQueue<AVFrame *>> videoFrameQueue,
-                                     std::shared_ptr<SafeQueue<AVFrame *>> audioFrameQueue,
+FFmpegReader::FFmpegReader(std::shared_ptr<SPSCQueue<AVFrame *>> videoFrameQueue,
+                                     std::shared_ptr<SPSCQueue<AVFrame *>> audioFrameQueue,
+                                     std::shared_ptr<FramePool> videoFramePool,
+                                     std::shared_ptr<FramePool> audioFramePool,
                                      ReaderType type) :
-        videoFrameQueue(std::move(videoFrameQueue)),
+        demuxer(std::make_unique<FFmpegDemuxer>()),
+        audioFrame(av_frame_alloc()),
+        videoFrame(av_frame_alloc()),
+        packetPool(std::make_shared<PacketPool>(PACKET_POOL_SIZE)),
+        audioPacketQueue(std::make_shared<PacketQueue>(packetPool)),
+        videoPacketQueue(std::make_shared<PacketQueue>(packetPool)),
         audioFrameQueue(std::move(audioFrameQueue)),
+        videoFrameQueue(std::move(videoFrameQueue)),
+        audioFramePool(std::move(audioFramePool)),
+        videoFramePool(std::move(videoFramePool)),
         readerType(type),
-        audioDemuxer(std::make_unique<FFmpegDemuxer>(FFmpegDemuxer::DemuxerType::AUDIO)),
-        videoDemuxer(std::make_unique<FFmpegDemuxer>(FFmpegDemuxer::DemuxerType::VIDEO)),
-        audioPacket(av_packet_alloc()),
-        videoPacket(av_packet_alloc()),
-        audioFrame(av_frame_alloc()),
-        videoFrame(av_frame_alloc())
+        // 音频: 200ms~1s, 4MB; 视频: 100ms~500ms, 32MB(4K YUV420P约12MB一帧，最多2帧)
+        audioQueueSizer({0.2, 1.0, 4 * 1024 * 1024, 4, this->audioFrameQueue->getMaxCapacity(), 10.0}),
+        videoQueueSizer({0.1, 0.5, 32 * 1024 * 1024, 2, this->videoFrameQueue->getMaxCapacity(), 10.0})
 {
 
 }
 
 FFmpegReader::~FFmpegReader() {
+    stop();
     releaseAudio();
     releaseVideo();
 }
@@ -28,55 +45,46 @@ FFmpegReader::~FFmpegReader() {
 bool FFmpegReader::open(const std::string &file_path) {
     filePath = file_path;
 
-    // 打开音频
-    if (!audioDemuxer->open(filePath)) {
-        LOGE("failed to open file for audio: %s", file_path.c_str());
+    // 只打开一次文件，音视频共用同一个AVFormatContext
+    if (!demuxer->open(filePath)) {
+        LOGE("failed to open file: %s", file_path.c_str());
         return false;
     }
 
+    audioPacketQueue->setTimeBase(demuxer->getAudioTimeBase());
+    videoPacketQueue->setTimeBase(demuxer->getVideoTimeBase());
+
     if (hasAudio()) {
         audioDecoder = std::make_unique<FFmpegAudioDecoder>();
         auto config = DecoderConfig();
-        config.param = audioDemuxer->getCodecParameters();
+        config.param = demuxer->getAudioCodecParameters();
         if (!audioDecoder->configure(config)) {
             LOGE("failed to configure audioDecoder");
             return false;
         }
     } else {
         releaseAudio();
-        audioDemuxer.reset();
     }
 
-    // 打开视频
-    if (!videoDemuxer->open(filePath)) {
-        LOGE("failed to open file for video: %s", file_path.c_str());
-        return false;
-    }
     if (hasVideo()) {
-//        videoDecoder = std::make_unique<FFmpegVideoDecoder>();
-        videoDecoder = std::make_unique<MediaCodecVideoDecoder>();
-        auto config = DecoderConfig();
-        // 获取SPS，PPS
-        std::vector<uint8_t> sps, pps;
-//        videoDemuxer->getCodecParameters()
-        extractSPSPPS(videoDemuxer->getCodecParameters(), sps, pps);
-        config.type = "video/avc";
-        config.format = config.fromAVFormat(static_cast<AVPixelFormat>(videoDemuxer->getCodecParameters()->format));
-        config.width = videoDemuxer->getCodecParameters()->width;
-        config.height = videoDemuxer->getCodecParameters()->height;
-        config.param = videoDemuxer->getCodecParameters();
-        config.extraData.emplace("sps", sps);
-        config.extraData.emplace("pps", pps);
-        if (!videoDecoder->configure(config)) {
-            LOGE("failed to configure videoDecoder");
+        // 优先使用平台硬解，码流超出硬解能力或配置失败时回退到FFmpeg软解
+        if (!videoDecoderFactory) {
+            std::atomic_store(&videoDecoderFactory, std::shared_ptr<DecoderFactory>(DecoderFactory::createDefault()));
+        }
+        videoDecoder = videoDecoderFactory->create(getVideoDecoderConfig());
+        auto selection = videoDecoderFactory->getSelection();
+        if (!videoDecoder) {
+            LOGE("failed to create video decoder: %s", selection.describe().c_str());
             return false;
         }
+        LOGI("use %s video decoder: %s", selection.name.c_str(), selection.describe().c_str());
 
-        OpenBsfCtx();
+        if (selection.needAnnexB) {
+            OpenBsfCtx();
+        }
 
     } else {
         releaseVideo();
-        videoDemuxer.reset();
     }
 
     return true;
@@ -88,19 +96,30 @@ void FFmpegReader::start() {
     isPaused = false;
     isReady = true;
 
-    if (hasAudio()) audioReadThread = std::thread(&FFmpegReader::audioReadThreadFunc, this);
-    if (hasVideo()) videoReadThread = std::thread(&FFmpegReader::videoReadThreadFunc, this);
+    audioPacketQueue->resume();
+    videoPacketQueue->resume();
+
+    demuxThread = std::thread(&FFmpegReader::demuxThreadFunc, this);
+    if (hasAudio()) audioDecodeThread = std::thread(&FFmpegReader::audioDecodeThreadFunc, this);
+    if (hasVideo()) videoDecodeThread = std::thread(&FFmpegReader::videoDecodeThreadFunc, this);
 }
 
 void FFmpegReader::pause() {
     LOGI("FFmpegReader pause");
     isPaused = true;
+    audioPacketQueue->pause();
+    videoPacketQueue->pause();
     audioFrameQueue->pause();
     videoFrameQueue->pause();
 }
 
 void FFmpegReader::resume() {
     isPaused = false;
+    audioPacketQueue->resume();
+    videoPacketQueue->resume();
+    audioFrameQueue->resume();
+    videoFrameQueue->resume();
+    demuxPauseCond.notify_all();
     if (hasAudio()) audioPauseCond.notify_all();
     if (hasVideo()) videoPauseCond.notify_all();
 }
@@ -110,48 +129,271 @@ void FFmpegReader::stop() {
     resume();
     LOGI("before flush, videoFrameQueue->getSize() = %d, audioFrameQueue->getSize() = %d",
          videoFrameQueue->getSize(), audioFrameQueue->getSize());
+    audioPacketQueue->flush();
+    videoPacketQueue->flush();
     audioFrameQueue->flush();
     videoFrameQueue->flush();
-    audioFrameQueue->resume();
-    videoFrameQueue->resume();
 
-    if (audioReadThread.joinable()) {
-        audioReadThread.join();
+    if (demuxThread.joinable()) {
+        demuxThread.join();
+    }
+    if (audioDecodeThread.joinable()) {
+        audioDecodeThread.join();
     }
-    if (videoReadThread.joinable()) {
-        videoReadThread.join();
+    if (videoDecodeThread.joinable()) {
+        videoDecodeThread.join();
     }
 
+    // 线程退出后再清理一次，释放退出过程中残留的数据
+    audioPacketQueue->flush();
+    videoPacketQueue->flush();
+    audioPacketQueue->resume();
+    videoPacketQueue->resume();
+    audioFrameQueue->resume();
+    videoFrameQueue->resume();
+
     LOGI("after stop, videoFrameQueue->getSize() = %d, audioFrameQueue->getSize() = %d",
          videoFrameQueue->getSize(), audioFrameQueue->getSize());
 }
 
-void FFmpegReader::seekTo(double position) {
+int FFmpegReader::seekTo(double position, SeekMode mode) {
+    if (position < 0) position = 0;
+    seekPosition = position;
+    seekMode = mode;
+    seekRequestTime = av_gettime_relative();
+    int serial = ++seekSerial;
+    TRACE_INSTANT("seek_request");
+    LOGI("seek request: %.3f, mode = %s, serial = %d", position,
+         mode == SeekMode::ACCURATE ? "accurate" : "keyframe", serial);
+
+    // 解封装线程可能因为暂停、文件结束或者缓冲已满在等待
+    demuxPauseCond.notify_all();
+    return serial;
+}
+
+void FFmpegReader::onFrameOutput(int serial, int skippedFrames) {
+    int measured = measuredSerial.load();
+    if (serial != seekSerial.load() || serial == measured) return;
+    if (!measuredSerial.compare_exchange_strong(measured, serial)) return;
+
+    double latency = (av_gettime_relative() - seekRequestTime.load()) / 1000.0;
+    SeekMode mode = seekMode;
+    lastSeekLatencyMs = latency;
+    {
+        std::lock_guard<std::mutex> lock(seekStatsMtx);
+        SeekStats& stats = seekStats[static_cast<int>(mode)];
+        stats.count++;
+        stats.lastMs = latency;
+        stats.avgMs += (latency - stats.avgMs) / stats.count;
+        stats.maxMs = std::max(stats.maxMs, latency);
+        stats.lastSkippedFrames = skippedFrames;
+    }
+    LOGI("seek latency: %.1fms (%s, serial = %d, skipped %d frames)", latency,
+         mode == SeekMode::ACCURATE ? "accurate" : "keyframe", serial, skippedFrames);
+}
+
+void FFmpegReader::setScrubbing(bool enable) {
+    LOGI("scrubbing %s", enable ? "begin" : "end");
+    scrubbing = enable;
+    demuxPauseCond.notify_all();
+}
+
+FFmpegReader::SeekStats FFmpegReader::getSeekStats(SeekMode mode) {
+    std::lock_guard<std::mutex> lock(seekStatsMtx);
+    return seekStats[static_cast<int>(mode)];
+}
+
+double FFmpegReader::getSkipTarget(int serial) const {
+    if (serial == 0 || serial != seekSerial.load() || seekMode != SeekMode::ACCURATE) {
+        return -1;
+    }
+    return seekPosition + demuxer->getStartTime();
+}
+
+void FFmpegReader::setReadAhead(double seconds, int64_t bytes) {
+    if (seconds > 0) maxBufferDuration = seconds;
+    if (bytes > 0) maxBufferBytes = bytes;
+    LOGI("read ahead: %.2f s, %lld bytes", maxBufferDuration.load(), (long long)maxBufferBytes.load());
+    demuxPauseCond.notify_all();
+}
 
+bool FFmpegReader::isBufferFull() const {
+    if (audioPacketQueue->getBytes() + videoPacketQueue->getBytes() >= maxBufferBytes) {
+        return true;
+    }
+
+    // 只要还有一个流没有缓冲够就继续读，避免交织间隔较大时另一个流的解码线程断粮
+    auto enough = [this](const std::shared_ptr<PacketQueue>& queue) {
+        return queue->getDuration() >= maxBufferDuration || queue->getSize() >= MAX_BUFFER_PACKETS;
+    };
+    bool audioEnough = !hasAudio() || enough(audioPacketQueue);
+    bool videoEnough = !hasVideo() || enough(videoPacketQueue);
+    return audioEnough && videoEnough;
 }
 
 bool FFmpegReader::hasVideo() const {
-    return videoDemuxer->hasVideo();
+    return demuxer->hasVideo();
 }
 
 bool FFmpegReader::hasAudio() const {
-    return audioDemuxer->hasAudio();
+    return demuxer->hasAudio();
 }
 
 AVRational FFmpegReader::getAudioTimeBase() const {
-    return audioDemuxer->getTimeBase();
+    return demuxer->getAudioTimeBase();
 }
 
 AVRational FFmpegReader::getVideoTimeBase() const {
-    return videoDemuxer->getTimeBase();
+    return demuxer->getVideoTimeBase();
+}
+
+void FFmpegReader::demuxThreadFunc() {
+    if (!isReadying()) {
+        LOGE("Reader is not ready, exit demuxThread");
+        return;
+    }
+    LOGI("FFmpegReader : start demux thread");
+    TRACE_THREAD_NAME("demux");
+
+    const int audioIdx = hasAudio() ? demuxer->getAudioStreamIndex() : -1;
+    const int videoIdx = hasVideo() ? demuxer->getVideoStreamIndex() : -1;
+
+    auto lastLogTime = std::chrono::steady_clock::now();
+    uint16_t audioPacketCount = 0;
+    uint16_t videoPacketCount = 0;
+    bool eof = false;
+    int demuxSerial = 0;
+    // 拖动模式下本次seek的关键帧已经送出，等待下一次seek
+    bool scrubServed = false;
+    // 连续读取失败的次数，成功读到packet或seek后清零
+    int readErrors = 0;
+
+    while (!exitRequested) {
+        {
+            // 暂停、已经读到文件末尾或者缓冲已满，有新的seek请求时立即处理
+            std::unique_lock<std::mutex> lk(demuxMtx);
+            while ((isPaused || eof || (scrubbing && scrubServed) || isBufferFull()) &&
+                   demuxSerial == seekSerial && !exitRequested) {
+                if (isPaused || eof || (scrubbing && scrubServed)) {
+                    demuxPauseCond.wait(lk);
+                } else {
+                    // 解码线程取走packet后会通知，这里再加一个超时兜底
+                    TRACE_SCOPE("demux_buffer_full_wait");
+                    demuxPauseCond.wait_for(lk, std::chrono::milliseconds(10));
+                }
+            }
+        }
+
+        if (exitRequested) break;
+
+        int serial = seekSerial.load();
+        if (serial != demuxSerial) {
+            // 先切换序号(同时丢弃队列中的旧packet)，再从新位置读取
+            {
+                TRACE_SCOPE("demux_seek");
+                demuxer->seekTo(seekPosition);
+            }
+            audioPacketQueue->setSerial(serial);
+            videoPacketQueue->setSerial(serial);
+            demuxSerial = serial;
+            eof = false;
+            scrubServed = false;
+            readErrors = 0;
+            readError = 0;
+            continue;
+        }
+
+        AVPacket* packet = packetPool->acquire();
+        int ret;
+        {
+            TRACE_SCOPE("demux_read");
+            ret = demuxer->ReceivePacket(packet);
+        }
+        if (ret < 0) {
+            packetPool->release(packet);
+            if (ret == AVERROR_EOF) {
+                // 通知解码线程进入drain流程
+                LOGI("demux reached end of file");
+                if (audioIdx >= 0) audioPacketQueue->push(nullptr);
+                if (videoIdx >= 0) videoPacketQueue->push(nullptr);
+                eof = true;
+            } else if (ret != AVERROR(EAGAIN) && ++readErrors >= MAX_READ_ERRORS) {
+                // 持续失败(例如网络源已断开)按出错结束: drain解码器并通知播放器，seek后会重新尝试读取
+                LOGE("demux giving up after %d consecutive read errors: %d", readErrors, ret);
+                if (audioIdx >= 0) audioPacketQueue->push(nullptr);
+                if (videoIdx >= 0) videoPacketQueue->push(nullptr);
+                eof = true;
+                readError = ret;
+                auto callback = errorCallback;
+                if (callback) callback(ret);
+            } else {
+                // 退避重试，避免读取错误时空转刷日志，seek或退出时立即唤醒
+                auto backoff = std::chrono::milliseconds(
+                        std::min(READ_RETRY_MAX_MS, 10 << std::min(std::max(readErrors - 1, 0), 5)));
+                std::unique_lock<std::mutex> lk(demuxMtx);
+                demuxPauseCond.wait_for(lk, backoff, [&] {
+                    return exitRequested || demuxSerial != seekSerial;
+                });
+            }
+            continue;
+        }
+        readErrors = 0;
+        if (playbackStats) playbackStats->addBytesRead(packet->size);
+
+        if (scrubbing && videoIdx >= 0) {
+            // 拖动中只需要目标位置附近可以独立解码的一帧: 音频和非关键帧直接丢弃
+            if (packet->stream_index == videoIdx && (packet->flags & AV_PKT_FLAG_KEY)) {
+                if (!videoPacketQueue->push(packet)) {
+                    packetPool->release(packet);
+                }
+                // 紧跟一个空包让解码器立即输出(多线程解码会缓存若干帧)，下一次seek会flush解码器
+                videoPacketQueue->push(nullptr);
+                scrubServed = true;
+            } else {
+                packetPool->release(packet);
+            }
+            continue;
+        }
+
+        // 按流分发
+        bool pushed = false;
+        if (packet->stream_index == videoIdx) {
+            pushed = videoPacketQueue->push(packet);
+            videoPacketCount++;
+            TRACE_COUNTER("video_packet_queue_kb", videoPacketQueue->getBytes() / 1024);
+        } else if (packet->stream_index == audioIdx) {
+            pushed = audioPacketQueue->push(packet);
+            audioPacketCount++;
+            TRACE_COUNTER("audio_packet_queue_kb", audioPacketQueue->getBytes() / 1024);
+        }
+        if (!pushed) {
+            packetPool->release(packet);
+        }
+
+        if (LOG_IS_ENABLED(DEBUG)) {
+            auto now = std::chrono::steady_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLogTime).count();
+            if (elapsed >= 3000) {
+                BufferLevel audioLevel = audioPacketQueue->getLevel();
+                BufferLevel videoLevel = videoPacketQueue->getLevel();
+                LOGD("解封装统计: 音频%d包 视频%d包/%.3f秒, 缓冲: 音频%d包/%lldKB/%.2f秒 视频%d包/%lldKB/%.2f秒",
+                     audioPacketCount, videoPacketCount, elapsed / 1000.0,
+                     audioLevel.packets, (long long)(audioLevel.bytes / 1024), audioLevel.duration,
+                     videoLevel.packets, (long long)(videoLevel.bytes / 1024), videoLevel.duration);
+                lastLogTime = now;
+                audioPacketCount = videoPacketCount = 0;
+            }
+        }
+    }
 }
 
-void FFmpegReader::audioReadThreadFunc() {
+void FFmpegReader::audioDecodeThreadFunc() {
     if (!isReadying()) {
-        LOGE("Reader is not ready, exit readThread");
+        LOGE("Reader is not ready, exit audioDecodeThread");
         return;
     }
-    LOGI("FFmpegReader : start audio read thread");
+    LOGI("FFmpegReader : start audio decode thread");
+    TRACE_THREAD_NAME("audio_decode");
 
     auto lastLogTime = std::chrono::steady_clock::now();
     uint16_t audioPacketCount = 0;
@@ -165,6 +407,16 @@ void FFmpegReader::audioReadThreadFunc() {
         }
     }
 
+    // 包装对象在线程内只创建一次，循环中只重新绑定packet
+    auto packetWrapper = std::make_shared<FFmpegPacket>();
+    std::shared_ptr<IMediaPacket> mediaPacket = packetWrapper;
+    std::shared_ptr<IMediaFrame> mediaFrame = std::make_shared<FFmpegFrame>(audioFrame);
+    bool audioQueuePrimed = false;
+    int decodeSerial = 0;
+    double skipUntil = -1;
+    int skippedFrames = 0;
+    AVRational audioTimeBase = getAudioTimeBase();
+
     while (!exitRequested) {
         {
             // 是否暂停
@@ -176,187 +428,376 @@ void FFmpegReader::audioReadThreadFunc() {
 
         if (exitRequested) break;
 
-        // 获取packet
-        audioDemuxer->ReceivePacket(audioPacket);
+        // 获取packet, nullptr表示流结束
+        AVPacket* audioPacket = nullptr;
+        int packetSerial = 0;
+        if (!audioPacketQueue->pop(audioPacket, packetSerial)) {
+            continue;
+        }
+        demuxPauseCond.notify_one();
+        if (packetSerial != decodeSerial) {
+            // seek之后的第一个packet，丢弃解码器中旧位置的数据
+            audioDecoder->flush();
+            decodeSerial = packetSerial;
+            skipUntil = getSkipTarget(decodeSerial);
+            skippedFrames = 0;
+        }
         audioPacketCount++;
-        std::shared_ptr<IMediaPacket> mediaPacket = std::make_shared<FFmpegPacket>(audioPacket);
-        std::shared_ptr<IMediaFrame> mediaFrame = std::make_shared<FFmpegFrame>(audioFrame);
-        if (audioDecoder->SendPacket(mediaPacket) == 0) {
+        packetWrapper->rebind(audioPacket);
+        if (audioDecoder->SendPacket(mediaPacket) != 0) {
             LOGE("audioDecoder SendPacket failed");
         }
         while (audioDecoder->ReceiveFrame(mediaFrame) == 0) {
-            AVFrame* cloneFrame = av_frame_clone(audioFrame);
+            if (playbackStats) playbackStats->onAudioFrameDecoded();
+            // 解码期间又有新的seek请求，旧数据不再入队
+            if (decodeSerial != seekSerial.load()) {
+                av_frame_unref(audioFrame);
+                continue;
+            }
+            // 精确seek: 结束时间在目标位置之前的帧不入队
+            if (skipUntil >= 0 && audioFrame->pts != AV_NOPTS_VALUE && audioFrame->sample_rate > 0) {
+                double end = audioFrame->pts * av_q2d(audioTimeBase) +
+                             (double)audioFrame->nb_samples / audioFrame->sample_rate;
+                if (end <= skipUntil) {
+                    av_frame_unref(audioFrame);
+                    skippedFrames++;
+                    continue;
+                }
+                skipUntil = -1;
+            }
 
-            if (downAudio) {
+            if (downAudio && outfile) {
                 int bytes_per_sample = av_get_bytes_per_sample(
                         static_cast<AVSampleFormat>(audioFrame->format));
                 int is_planar = av_sample_fmt_is_planar(static_cast<AVSampleFormat>(audioFrame->format));
                 if (is_planar) {
                     for (int s = 0; s < audioFrame->nb_samples; ++s) {
-                        for (int ch = 0; ch < audioFrame->channels; ++ch) {
+                        for (int ch = 0; ch < getChannelCount(audioFrame); ++ch) {
                             fwrite(audioFrame->data[ch] + s * bytes_per_sample, 1, bytes_per_sample, outfile);
                         }
                     }
                 }
             }
 
-            if (!audioFrameQueue->push(cloneFrame)) {
+            int sampleBytes = av_samples_get_buffer_size(nullptr, getChannelCount(audioFrame), audioFrame->nb_samples,
+                                                         static_cast<AVSampleFormat>(audioFrame->format), 1);
+            double frameDuration = audioFrame->sample_rate > 0 ?
+                                   (double)audioFrame->nb_samples / audioFrame->sample_rate : 0;
+            adjustFrameQueue(*audioFrameQueue, audioQueueSizer, audioFrame,
+                             sampleBytes > 0 ? sampleBytes : 0, frameDuration, audioQueuePrimed);
+
+            // 只转移数据引用到池中的AVFrame，不再每帧clone
+            AVFrame* outFrame = audioFramePool->acquire();
+            av_frame_move_ref(outFrame, audioFrame);
+            setFrameSerial(outFrame, decodeSerial);
+            if (!audioFrameQueue->push(outFrame)) {
                 LOGE("Failed to push frame to audioFrameQueue");
-                av_frame_unref(cloneFrame);
+                audioFramePool->release(outFrame);
+            } else if (!hasVideo()) {
+                onFrameOutput(decodeSerial, skippedFrames);
             }
             audioFrameCount++;
-            av_frame_unref(audioFrame);
         }
 
-        av_packet_unref(audioPacket);
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLogTime).count();
-        if (elapsed >= 3000) {
-            LOGI("音频解封装统计: %d帧/%.3f秒 (%.2f帧/秒)",
-                 audioPacketCount, elapsed / 1000.0,
-                 audioPacketCount / (elapsed / 1000.0f));
-            LOGI("音频解码统计: %d帧/%.3f秒 (%.2f帧/秒), 队列大小: %d",
-                 audioFrameCount, elapsed / 1000.0,
-                 audioFrameCount / (elapsed / 1000.0f), audioFrameQueue->getSize());
-            lastLogTime = now;
-            audioPacketCount = audioFrameCount = 0;
+        packetPool->release(audioPacket);
+        if (LOG_IS_ENABLED(DEBUG)) {
+            auto now = std::chrono::steady_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLogTime).count();
+            if (elapsed >= 3000) {
+                LOGD("音频解码统计: %d包 %d帧/%.3f秒 (%.2f帧/秒), 队列大小: %d/%zu, 帧池命中/未命中: %llu/%llu",
+                     audioPacketCount, audioFrameCount, elapsed / 1000.0,
+                     audioFrameCount / (elapsed / 1000.0f), audioFrameQueue->getSize(), audioFrameQueue->getMaxSize(),
+                     (unsigned long long)audioFramePool->getHitCount(),
+                     (unsigned long long)audioFramePool->getMissCount());
+                lastLogTime = now;
+                audioPacketCount = audioFrameCount = 0;
+            }
         }
     }
-    if (downAudio) {
+    if (outfile) {
         fclose(outfile);
     }
 }
 
-void FFmpegReader::videoReadThreadFunc() {
+void FFmpegReader::videoDecodeThreadFunc() {
     if (!isReadying()) {
-        LOGE("Reader is not ready, exit readThread");
+        LOGE("Reader is not ready, exit videoDecodeThread");
         return;
     }
-    LOGI("FFmpegReader : start video read thread");
+    LOGI("FFmpegReader : start video decode thread");
+    TRACE_THREAD_NAME("video_decode");
 
     auto lastLogTime = std::chrono::steady_clock::now();
     uint16_t videoPacketCount = 0;
     uint16_t videoFrameCount = 0;
+
+    auto packetWrapper = std::make_shared<FFmpegPacket>();
+    std::shared_ptr<IMediaPacket> mediaPacket = packetWrapper;
+    std::shared_ptr<IMediaFrame> mediaFrame = std::make_shared<FFmpegFrame>(videoFrame);
+    bool videoQueuePrimed = false;
+    int decodeSerial = 0;
+    double skipUntil = -1;
+    int skippedFrames = 0;
+    AVDiscard frameDiscard = AVDISCARD_DEFAULT;
+    double frameInterval = 0;
+
+    // MediaCodec输出的帧没有pkt_duration，用流的平均帧率兜底
+    AVRational frameRate = demuxer->getVideoStream()->avg_frame_rate;
+    double defaultFrameDuration = frameRate.num > 0 && frameRate.den > 0 ? av_q2d(av_inv_q(frameRate)) : 0.04;
+    AVRational videoTimeBase = getVideoTimeBase();
+
+    // 解码器输出第一帧之前送入的packet(Annex-B转换之前)，回退到下一个解码器时从头重新送入
+    DecoderFactory::StartupMonitor startupMonitor;
+    std::vector<AVPacket*> startupPackets;
+
+    // 送入一个packet(nullptr表示流结束)并取出所有输出帧，返回SendPacket的结果
+    auto decodePacket = [&](AVPacket* packet) {
+        videoPacketCount++;
+        packetWrapper->rebind(packet);
+        if (packet && m_absCtx) {
+            ConvertAVCCToAnnexB(packet);
+        }
+        // 解码耗时只统计SendPacket和ReceiveFrame本身，不包括帧队列满时的等待
+        int64_t decodeBegin = av_gettime_relative();
+        int sendRet = videoDecoder->SendPacket(mediaPacket);
+        if (sendRet != 0) {
+            LOGE("VideoDecoder SendPacket failed");
+        }
+        int64_t decodeUs = av_gettime_relative() - decodeBegin;
+        for (;;) {
+            int64_t receiveBegin = av_gettime_relative();
+            int receiveRet = videoDecoder->ReceiveFrame(mediaFrame);
+            decodeUs += av_gettime_relative() - receiveBegin;
+            if (receiveRet != 0) break;
+            if (playbackStats) playbackStats->onVideoFrameDecoded();
+            startupMonitor.onFrame();
+
+            if (decodeSerial != seekSerial.load()) {
+                av_frame_unref(videoFrame);
+                continue;
+            }
+            // 精确seek: 目标帧之前的帧解码后直接丢弃，不入队也不上传纹理
+            if (skipUntil >= 0 && videoFrame->pts != AV_NOPTS_VALUE) {
+                double duration = getFrameDuration(videoFrame) > 0 ?
+                                  getFrameDuration(videoFrame) * av_q2d(videoTimeBase) : defaultFrameDuration;
+                if (videoFrame->pts * av_q2d(videoTimeBase) + duration <= skipUntil) {
+                    av_frame_unref(videoFrame);
+                    skippedFrames++;
+                    continue;
+                }
+                skipUntil = -1;
+            }
+            int imageBytes = av_image_get_buffer_size(static_cast<AVPixelFormat>(videoFrame->format),
+                                                      videoFrame->width, videoFrame->height, 1);
+            double frameDuration = getFrameDuration(videoFrame) > 0 && videoTimeBase.den > 0 ?
+                                   getFrameDuration(videoFrame) * av_q2d(videoTimeBase) : defaultFrameDuration;
+            adjustFrameQueue(*videoFrameQueue, videoQueueSizer, videoFrame,
+                             imageBytes > 0 ? imageBytes : 0, frameDuration, videoQueuePrimed);
+
+            AVFrame* outFrame = videoFramePool->acquire();
+            av_frame_move_ref(outFrame, videoFrame);
+            setFrameSerial(outFrame, decodeSerial);
+            if (!videoFrameQueue->push(outFrame)) {
+                LOGE("Failed to push frame to videoFrameQueue");
+                videoFramePool->release(outFrame);
+            } else {
+                onFrameOutput(decodeSerial, skippedFrames);
+            }
+            videoFrameCount++;
+        }
+        if (playbackStats && packet) playbackStats->recordVideoDecodeTime(decodeUs);
+        return sendRet;
+    };
+
+    auto clearStartupPackets = [&]() {
+        for (AVPacket* packet : startupPackets) packetPool->release(packet);
+        startupPackets.clear();
+    };
+    auto feedPacket = [&](AVPacket* packet) {
+        AVPacket* kept = nullptr;
+        if (startupMonitor.isWatching() && packet) {
+            kept = packetPool->acquire();
+            if (av_packet_ref(kept, packet) < 0) {
+                packetPool->release(kept);
+                kept = nullptr;
+            }
+        }
+        int ret = decodePacket(packet);
+        if (packet) startupMonitor.onPacketSent(ret);
+        if (kept && startupMonitor.isWatching()) {
+            startupPackets.push_back(kept);
+        } else {
+            packetPool->release(kept);
+        }
+        if (!startupMonitor.isWatching() && !startupPackets.empty()) clearStartupPackets();
+    };
+
     while (!exitRequested) {
         {
             std::unique_lock<std::mutex> lk(videoMtx);
             while (isPaused && !exitRequested) {
                 videoPauseCond.wait(lk);
             }
+        }
 
-            if (exitRequested) break;
+        if (exitRequested) break;
 
-            videoDemuxer->ReceivePacket(videoPacket);
-            videoPacketCount++;
-            std::shared_ptr<IMediaPacket> mediaPacket = std::make_shared<FFmpegPacket>(videoPacket);
-            ConvertAVCCToAnnexB(mediaPacket->asAVPacket());
-            std::shared_ptr<IMediaFrame> mediaFrame = std::make_shared<FFmpegFrame>(videoFrame);
-            if (videoDecoder->SendPacket(mediaPacket) != 0) {
-                LOGE("VideoDecoder SendPacket failed");
+        // 获取packet, nullptr表示流结束
+        AVPacket* videoPacket = nullptr;
+        int packetSerial = 0;
+        if (!videoPacketQueue->pop(videoPacket, packetSerial)) {
+            continue;
+        }
+        demuxPauseCond.notify_one();
+        if (packetSerial != decodeSerial) {
+            videoDecoder->flush();
+            if (m_absCtx) av_bsf_flush(m_absCtx);
+            // seek之后从新的关键帧开始，之前保留的packet不再需要重新送入
+            clearStartupPackets();
+            decodeSerial = packetSerial;
+            skipUntil = getSkipTarget(decodeSerial);
+            skippedFrames = 0;
+            // seek之后从关键帧重新开始，不再落后
+            if (lateFrameController) lateFrameController->reset();
+            frameDiscard = AVDISCARD_DEFAULT;
+            videoDecoder->setFrameDiscard(frameDiscard);
+        }
+
+        // 精确seek: 目标位置之前的非参考帧不会被后续帧引用，解码器可以直接跳过
+        AVDiscard discard = AVDISCARD_DEFAULT;
+        if (skipUntil >= 0 && videoPacket && videoPacket->pts != AV_NOPTS_VALUE &&
+            (videoPacket->pts + videoPacket->duration) * av_q2d(videoTimeBase) <= skipUntil) {
+            discard = AVDISCARD_NONREF;
+        }
+        // 高倍速播放时大部分帧来不及显示，不被引用的帧直接不解码
+        if (playbackRate > FAST_PLAYBACK_RATE) {
+            discard = std::max(discard, AVDISCARD_NONREF);
+        }
+        // 渲染落后时的降级。从只解码关键帧恢复要等到下一个关键帧，否则之后的帧引用的参考帧没有解码过
+        if (lateFrameController) {
+            AVDiscard lateDiscard = lateFrameController->getFrameDiscard();
+            if (frameDiscard == AVDISCARD_NONKEY && lateDiscard < AVDISCARD_NONKEY &&
+                videoPacket && !(videoPacket->flags & AV_PKT_FLAG_KEY)) {
+                lateDiscard = AVDISCARD_NONKEY;
             }
-            while (videoDecoder->ReceiveFrame(mediaFrame) == 0) {
-                AVFrame* cloneFrame = av_frame_clone(videoFrame);
-                if (!videoFrameQueue->push(cloneFrame)) {
-                    LOGE("Failed to push frame to audioFrameQueue");
-                    av_frame_unref(cloneFrame);
-                }
-                videoFrameCount++;
-                av_frame_unref(videoFrame);
+            discard = std::max(discard, lateDiscard);
+        }
+        if (discard != frameDiscard) {
+            videoDecoder->setFrameDiscard(discard);
+            frameDiscard = discard;
+        }
+        // 软解按每帧可用的时间判断是否需要降质，倍速播放时相应缩短
+        const double rate = playbackRate;
+        const double interval = rate > 0 ? defaultFrameDuration / rate : defaultFrameDuration;
+        if (interval != frameInterval) {
+            videoDecoder->setFrameInterval(interval);
+            frameInterval = interval;
+        }
+        feedPacket(videoPacket);
+
+        // 解码开始阶段失败(硬解报错或一直不出帧)时换用下一个解码器，重新送入之前的packet
+        std::string failReason;
+        while (startupMonitor.failed(failReason)) {
+            if (!videoDecoderFactory->hasFallback() || !fallbackVideoDecoder(failReason)) {
+                LOGE("video decoder failed (%s), keep using it", failReason.c_str());
+                startupMonitor.stop();
+                clearStartupPackets();
+                break;
             }
+            videoDecoder->setFrameDiscard(frameDiscard);
+            videoDecoder->setFrameInterval(frameInterval);
+            startupMonitor.reset();
+            std::vector<AVPacket*> replay;
+            replay.swap(startupPackets);
+            for (AVPacket* packet : replay) {
+                feedPacket(packet);
+            }
+            for (AVPacket* packet : replay) packetPool->release(packet);
+        }
 
-            av_packet_unref(videoPacket);
+        packetPool->release(videoPacket);
+        if (LOG_IS_ENABLED(DEBUG)) {
             auto now = std::chrono::steady_clock::now();
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLogTime).count();
             if (elapsed >= 3000) {
-                LOGI("视频解封装统计: %d帧/%.3f秒 (%.2f帧/秒)",
-                     videoPacketCount, elapsed / 1000.0,
-                     videoPacketCount / (elapsed / 1000.0f));
-                LOGI("视频解码统计: %d帧/%.3f秒 (%.2f帧/秒), 队列大小: %d",
-                     videoFrameCount, elapsed / 1000.0,
-                     videoFrameCount / (elapsed / 1000.0f), videoFrameQueue->getSize());
+                LOGD("视频解码统计: %d包 %d帧/%.3f秒 (%.2f帧/秒), 队列大小: %d/%zu, 帧池命中/未命中: %llu/%llu",
+                     videoPacketCount, videoFrameCount, elapsed / 1000.0,
+                     videoFrameCount / (elapsed / 1000.0f), videoFrameQueue->getSize(), videoFrameQueue->getMaxSize(),
+                     (unsigned long long)videoFramePool->getHitCount(),
+                     (unsigned long long)videoFramePool->getMissCount());
                 lastLogTime = now;
                 videoPacketCount = videoFrameCount = 0;
             }
         }
     }
+    clearStartupPackets();
 }
 
-void FFmpegReader::releaseAudio() {
-    if (audioPacket) {
-        av_packet_free(&audioPacket);
+void FFmpegReader::adjustFrameQueue(SPSCQueue<AVFrame*>& queue, FrameQueueSizer& sizer,
+                                    const AVFrame* frame, size_t frameBytes, double frameDuration, bool& primed) {
+    // 队列曾经有过数据之后又被取空才算欠载，刚启动时的空队列不算
+    int size = queue.getSize();
+    bool underrun = primed && size == 0 && !isPaused;
+    if (size > 0) primed = true;
+
+    size_t capacity = sizer.update(frameBytes, frameDuration, underrun);
+    if (capacity != queue.getMaxSize()) {
+        queue.setMaxSize(capacity);
+        LOGI("帧队列容量调整为%zu (缓冲时长%.0fms, 单帧%zuKB/%.1fms, 欠载%d次), format = %d",
+             capacity, sizer.getWindow() * 1000, frameBytes / 1024, frameDuration * 1000,
+             sizer.getUnderrunCount(), frame->format);
     }
+}
 
+void FFmpegReader::releaseAudio() {
     if (audioFrame) {
         av_frame_free(&audioFrame);
     }
 }
 
 void FFmpegReader::releaseVideo() {
-    if (videoPacket) {
-        av_packet_free(&videoPacket);
-    }
     if (videoFrame) {
         av_frame_free(&videoFrame);
     }
+    if (m_absCtx) {
+        av_bsf_free(&m_absCtx);
+    }
 }
 
-bool FFmpegReader::extractSPSPPS(AVCodecParameters *codecParams, std::vector<uint8_t> &sps,
-                                 std::vector<uint8_t> &pps) {
-    if (!codecParams || !codecParams->extradata || codecParams->extradata_size < 7) {
-        LOGE("Invalid extradata");
-        return false;
+DecoderConfig FFmpegReader::getVideoDecoderConfig() {
+    auto codecParameters = demuxer->getVideoCodecParameters();
+    auto config = DecoderConfig();
+    config.format = config.fromAVFormat(static_cast<AVPixelFormat>(codecParameters->format));
+    config.width = codecParameters->width;
+    config.height = codecParameters->height;
+    config.param = codecParameters;
+    // 没有时长的是直播流，解码器不能使用会增加延迟的帧级多线程
+    if (demuxer->getDuration() <= 0) {
+        config.parameters["latency"] = "live";
     }
-    AVFormatContext* fmt;
-
-    const uint8_t* extradata = codecParams->extradata;
-    int extradata_size = codecParams->extradata_size;
-    std::vector<uint8_t> startCode = {0x00, 0x00, 0x00, 0x01};
-
-    // 检查是否为AVCC格式（一般mp4容器采用）
-    if (extradata[0] == 1) { // AVCC格式以1开头
-        int offset = 5;      // 跳过版本、profile、compatibility、level和长度字段
-
-        while (true) {
-            // 获取SPS或者PPS个数,第六个字节[111......]前三个bit默认为111，后五个bit表示接下来的SPS或者PPS个数
-            int num = extradata[offset] & 0x1F;
-            offset++;
-
-            for (int i = 0; i < num; ++i) {
-                // 读取当前SPS或者PPS长度, 2字节大端序
-                int length = (extradata[offset] << 8) | extradata[offset + 1];
-                offset += 2;
-                // 获取类型
-                int type = extradata[offset] & 0x0F;
-
-                // 目前只保留第一个SPS或PPS
-                if (i == 0) {
-                    if (type == 7) {
-                        sps.assign(startCode.begin(), startCode.end());
-                        sps.reserve(4 + length);
-                        sps.insert(sps.end(), extradata + offset, extradata + offset + length);
-                        offset += length;
-                        break;
-                    } else if (type == 8) {
-                        pps.assign(startCode.begin(), startCode.end());
-                        pps.reserve(4 + length);
-                        pps.insert(pps.end(), extradata + offset, extradata + offset + length);
-                        offset += length;
-                        break;
-                    }
-                }
-            }
-            if (!sps.empty() && !pps.empty()) {
-                break;
-            }
-        }
-        return !sps.empty() && ! pps.empty();
-    } else if (extradata[0] == 0 && extradata[1] == 0 &&
-               extradata[2] == 0 && extradata[3] == 1){ // 格式为Annex-B(开头是起始码0x00000001)
-
+    return config;
+}
 
+bool FFmpegReader::fallbackVideoDecoder(const std::string& reason) {
+    auto decoder = videoDecoderFactory->fallback(getVideoDecoderConfig(), reason);
+    auto selection = videoDecoderFactory->getSelection();
+    if (!decoder) {
+        LOGE("video decoder failed (%s) and no fallback is available: %s", reason.c_str(),
+             selection.describe().c_str());
+        return false;
     }
+    LOGW("video decoder failed (%s), fall back to %s: %s", reason.c_str(), selection.name.c_str(),
+         selection.describe().c_str());
+    videoDecoder = std::move(decoder);
 
-    return false;
+    // 新的解码器对输入格式的要求可能不同
+    if (m_absCtx) {
+        av_bsf_free(&m_absCtx);
+    }
+    if (selection.needAnnexB) {
+        OpenBsfCtx();
+    }
+    return true;
 }
 
 int FFmpegReader::ConvertAVCCToAnnexB(AVPacket *packet) {
@@ -382,7 +823,7 @@ int FFmpegReader::OpenBsfCtx() {
     const AVBitStreamFilter *bsFilter = nullptr;
     AVCodecParameters *codecParameters = nullptr;
 
-    auto videoStream = videoDemuxer->getAVStream();
+    auto videoStream = demuxer->getVideoStream();
 
     auto codecID = videoStream->codecpar->codec_id;
     auto codecDesc = avcodec_descriptor_get(codecID);
@@ -2,13 +2,20 @@
 // Created by Weichuandong on 2025/3/10.
 //
 
+#define LOG_TAG "RenderThread"
+
 #include "RenderThread.h"
+#include "core/Trace.hpp"
+#include "core/DeferredLog.hpp"
+#include "platform/FFmpegCompat.h"
 
-RenderThread::RenderThread(std::shared_ptr<SafeQueue<AVFrame*>> frameQueue,
+RenderThread::RenderThread(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                           std::shared_ptr<FramePool> framePool,
                            std::shared_ptr<MediaSynchronizer> sync) :
-    videoFrameQueue(std::move(frameQueue)),
     renderer(nullptr),
     eglCore(nullptr),
+    videoFrameQueue(std::move(frameQueue)),
+    videoFramePool(std::move(framePool)),
     synchronizer(std::move(sync))
 {
 
@@ -54,6 +61,7 @@ bool RenderThread::isRunning() const {
 
 void RenderThread::renderLoop() {
     LOGI("RenderThread : start render thread");
+    TRACE_THREAD_NAME("render");
     // 确保在渲染线程中使用EGL上下文
     if(!eglCore->makeCurrent()) {
         LOGE("Can not makeCurrent");
@@ -69,12 +77,17 @@ void RenderThread::renderLoop() {
 
     auto lastLogTime = std::chrono::steady_clock::now();
     uint16_t renderFrameCount = 0;
-    double syncThreshold = 0.02;   // 20ms同步阈值
+    int lastSerial = -1;
+    double lastRate = 1.0;
 
     while (!exitRequest) {
         //判断是否暂停
         {
             std::unique_lock<std::mutex> lock(mtx);
+            if (isPaused) {
+                if (framePacing) framePacing->markDiscontinuity();
+                scheduler.reset();
+            }
             while (isPaused && !exitRequest) {
                 pauseCond.wait(lock);
             }
@@ -82,56 +95,125 @@ void RenderThread::renderLoop() {
 
         executeGLTasks();
 
+        // 切换文件时Player会换一个新的synchronizer，本轮统一使用同一个
+        std::shared_ptr<MediaSynchronizer> sync = std::atomic_load(&synchronizer);
+
+        // 本轮绘制的帧，交换缓冲区后交给帧节奏分析
+        bool presented = false;
+        double presentedPts = 0;
+        int64_t intendedUs = 0;
+        int64_t drawUs = 0;
+
         if (renderer) {
             // 取AVFrame
 //            std::shared_ptr<IMediaFrame> frame = nullptr;
             AVFrame* avFrame{nullptr};
             videoFrameQueue->pop(avFrame);
+            TRACE_COUNTER("video_frame_queue", videoFrameQueue->getSize());
+
+            // seek之前的旧帧直接丢弃，不上传纹理也不参与同步
+            if (avFrame && sync && getFrameSerial(avFrame) < sync->getSerial()) {
+                TRACE_INSTANT("video_drop_stale_frame");
+                if (playbackStats) playbackStats->onVideoFrameDropped();
+                videoFramePool->release(avFrame);
+                continue;
+            }
+
+            // seek之后时间线不连续，不与之前的帧比较显示间隔
+            if (avFrame && getFrameSerial(avFrame) != lastSerial) {
+                lastSerial = getFrameSerial(avFrame);
+                if (framePacing) framePacing->markDiscontinuity();
+                scheduler.reset();
+            }
+            // 播放速度: pts的差值除以速度才是墙上时间
+            double rate = sync ? sync->getPlaybackRate() : 1.0;
+            if (rate != lastRate) {
+                lastRate = rate;
+                if (framePacing) framePacing->markDiscontinuity();
+                scheduler.reset();
+            }
 
 //            AVFrame* avFrame = frame->asAVFrame();
             if (avFrame && avFrame->width && avFrame->height) {
                 // 添加时钟同步逻辑
-                double masterTime = synchronizer ? synchronizer->getCurrentTime() : videoClock.getCurrentTime();
+                double masterTime = sync ? sync->getCurrentTime() : videoClock.getCurrentTime();
+                int64_t syncUs = scheduler.now();
 
-                // 更新视频时钟
-                if (avFrame->pts != AV_NOPTS_VALUE) {
-                    videoClock.pts = avFrame->pts * av_q2d(videoTimeBase);
-                    videoClock.lastUpdateTime = av_gettime() / 1000000.0;
-                    synchronizer->update(videoClock, MediaSynchronizer::SyncSource::VIDEO);
-                }
+                // 视频时钟只在帧真正显示时更新(见drawFrame之前)，被丢弃的帧不推动时钟
+                const bool hasPts = avFrame->pts != AV_NOPTS_VALUE;
+                const double framePts = hasPts ? avFrame->pts * av_q2d(videoTimeBase) : videoClock.pts;
 
                 // 计算时间差值
-                double diff = videoClock.pts - masterTime;
-                LOGD("diff = %lf, videoPts = %lf, masterTime = %lf", diff, videoClock.pts, masterTime);
-
-                if (diff <= -syncThreshold) {
-                    // 视频慢
-                    LOGD("video is %lfS slow", fabs(diff));
-                    renderer->onDrawFrame(avFrame);
-
-                    if (diff < -10 * syncThreshold && videoFrameQueue->getSize() > 0) {
-                        // 如果视频极其落后
-                        // 丢帧逻辑
-//                        videoFrameQueue->pop(frame);
-//                        LOGW("video is severely outdated, with a frame loss timestamp of : %f", frame->pts * av_q2d(videoTimeBase));
-//                        av_frame_unref(frame);
-//                        continue;
+                double diff = framePts - masterTime;
+                TRACE_COUNTER("av_diff_us", diff * 1000000);
+                if (playbackStats) playbackStats->recordAvDrift(diff);
+                // 每帧都会执行，使用延迟格式化，Release构建中不产生代码
+                LOGD_DEFERRED("diff = %lf, videoPts = %lf, masterTime = %lf", diff, framePts, masterTime);
+
+                // 向前看一帧，同一时间线上的下一帧的pts
+                double nextPts = NAN;
+                bool hasNextFrame = videoFrameQueue->peek([&](AVFrame* next) {
+                    if (next && getFrameSerial(next) == lastSerial && next->pts != AV_NOPTS_VALUE) {
+                        nextPts = next->pts * av_q2d(videoTimeBase);
                     }
-                } else if (diff >= syncThreshold) {
-                    // 视频快
-                    int waitTime = std::min(100, (int)(diff * 1000));
-                    LOGD("video is %lfS fast, sleep %dms", fabs(diff), waitTime);
+                });
+
+                // 已经落后的帧在上传纹理之前丢弃，同时由控制器决定是否让解码线程跳帧
+                if (lateFrameController) {
+                    double frameDuration = getFrameDuration(avFrame) * av_q2d(videoTimeBase);
+                    if (lateFrameController->onFrame(diff, frameDuration, hasNextFrame)) {
+                        TRACE_INSTANT("video_drop_late_frame");
+                        LOGD_DEFERRED("drop late frame, pts = %lf, %lfS late", framePts, -diff);
+                        if (playbackStats) playbackStats->onVideoFrameDroppedLate();
+                        videoFramePool->release(avFrame);
+                        continue;
+                    }
+                }
+
+                // 对齐到vsync计算提交时刻，下一帧会占用同一个vsync时这一帧不会被看到
+                auto decision = scheduler.schedule(framePts, nextPts, masterTime, syncUs, rate);
+                if (decision.action == PresentationScheduler::Action::DROP) {
+                    TRACE_INSTANT("video_drop_same_vsync");
+                    LOGD_DEFERRED("drop frame sharing vsync with next, pts = %lf", framePts);
+                    if (playbackStats) playbackStats->onVideoFrameDropped();
+                    videoFramePool->release(avFrame);
+                    continue;
+                }
+
+                // 主时钟走到该帧pts的时刻
+                intendedUs = decision.targetUs;
+                presentedPts = framePts / rate;
+                presented = true;
 
-                    std::this_thread::sleep_for(std::chrono::milliseconds(waitTime));
-                    renderer->onDrawFrame(avFrame);
+                if (decision.deadlineUs > syncUs) {
+                    // 视频快
+                    LOGD_DEFERRED("video is %lfS fast, wait %lldus", diff, (long long)(decision.deadlineUs - syncUs));
+                    TRACE_SCOPE("sync_wait");
+                    // 暂停、退出或seek时不再等待，放弃这一帧
+                    bool reached = scheduler.waitUntil(decision.deadlineUs, [this, &sync, lastSerial]() {
+                        return isPaused || exitRequest ||
+                               (sync && lastSerial < sync->getSerial());
+                    });
+                    if (!reached) {
+                        videoFramePool->release(avFrame);
+                        continue;
+                    }
                 } else {
-                    LOGD("audio and video synchronization");
-                    renderer->onDrawFrame(avFrame);
+                    LOGD_DEFERRED("video is %lfS slow", -diff);
                 }
+                // 更新视频时钟
+                if (hasPts) {
+                    videoClock.pts = framePts;
+                    videoClock.lastUpdateTime = av_gettime_relative() / 1000000.0;
+                    if (sync) sync->update(videoClock, MediaSynchronizer::SyncSource::VIDEO);
+                }
+                drawUs = drawFrame(avFrame);
             } else {
                 // frame无效
 
             }
+            // 纹理已经上传，归还AVFrame
+            videoFramePool->release(avFrame);
         }
 
         if (isPaused) continue;
@@ -142,23 +224,42 @@ void RenderThread::renderLoop() {
             continue;
         }
         // 交换缓冲区
-        eglCore->swapBuffers();
-
-        renderFrameCount++;
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLogTime);
-        if (elapsed.count() >= 3000) {
-            double elapsedSeconds = elapsed.count() / 1000.0;
-            LOGI("渲染统计: %d帧/%.3f秒 (%.2f帧/秒)",
-                 renderFrameCount, elapsedSeconds,
-                 renderFrameCount/elapsedSeconds);
-            renderFrameCount = 0;
-            lastLogTime = now;
+        {
+            TRACE_SCOPE("swap_buffers");
+            eglCore->swapBuffers();
+        }
+        if (presented && framePacing) {
+            framePacing->onFramePresented(presentedPts, intendedUs, drawUs, av_gettime_relative());
+        }
+
+        // 周期性统计只在DEBUG级别编译，Release中由Player::getStats()获取
+        if (LOG_IS_ENABLED(DEBUG)) {
+            renderFrameCount++;
+            auto now = std::chrono::steady_clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastLogTime);
+            if (elapsed.count() >= 3000) {
+                double elapsedSeconds = elapsed.count() / 1000.0;
+                LOGD("渲染统计: %d帧/%.3f秒 (%.2f帧/秒)",
+                     renderFrameCount, elapsedSeconds,
+                     renderFrameCount/elapsedSeconds);
+                renderFrameCount = 0;
+                lastLogTime = now;
+            }
         }
     }
     LOGI("Render loop stopped");
 }
 
+int64_t RenderThread::drawFrame(AVFrame* frame) {
+    int64_t begin = av_gettime_relative();
+    renderer->onDrawFrame(frame);
+    if (playbackStats) {
+        playbackStats->recordUploadTime(av_gettime_relative() - begin);
+        playbackStats->onVideoFrameRendered();
+    }
+    return begin;
+}
+
 void RenderThread::pause() {
     LOGI("RenderThread pause");
     isPaused = true;
@@ -192,7 +293,19 @@ bool RenderThread::isReadying() const {
 }
 
 void RenderThread::setSync(const std::shared_ptr<MediaSynchronizer>& sync) {
-    synchronizer = sync;
+    std::atomic_store(&synchronizer, sync);
+}
+
+void RenderThread::setStats(const std::shared_ptr<PlaybackStats>& stats) {
+    playbackStats = stats;
+}
+
+void RenderThread::setFramePacing(const std::shared_ptr<FramePacing>& pacing) {
+    framePacing = pacing;
+}
+
+void RenderThread::setLateFrameController(const std::shared_ptr<LateFrameController>& controller) {
+    lateFrameController = controller;
 }
 
 void RenderThread::setTimeBase(const AVRational &timeBase) {
@@ -1,6 +1,8 @@
 //
 // Created by Weichuandong on 2025/3/8.
 //
+#define LOG_TAG "GLRenderer"
+
 #include "Renderer/GLRenderer.h"
 
 #include <utility>
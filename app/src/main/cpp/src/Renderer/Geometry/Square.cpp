@@ -1,6 +1,8 @@
 //
 // Created by Weichuandong on 2025/3/13.
 //
+#define LOG_TAG "Geometry"
+
 #include "Renderer/Geometry/Square.h"
 
 void Square::init() {
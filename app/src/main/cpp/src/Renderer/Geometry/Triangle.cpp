@@ -1,6 +1,8 @@
 //
 // Created by Weichuandong on 2025/3/10.
 //
+#define LOG_TAG "Geometry"
+
 #include "Renderer/Geometry/Triangle.h"
 
 void Triangle::init() {
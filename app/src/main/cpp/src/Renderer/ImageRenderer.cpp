@@ -2,6 +2,8 @@
 // Created by Weichuandong on 2025/3/10.
 //
 
+#define LOG_TAG "ImageRenderer"
+
 #include "Renderer/ImageRenderer.h"
 
 
@@ -2,7 +2,10 @@
 // Created by Weichuandong on 2025/3/21.
 //
 
+#define LOG_TAG "VideoRenderer"
+
 #include "Renderer/VideoRenderer.h"
+#include "core/Trace.hpp"
 
 VideoRenderer::VideoRenderer() :
     mode(ScalingMode::FIT)
@@ -145,6 +148,7 @@ void VideoRenderer::create_textures() {
 }
 
 void VideoRenderer::update_textures(AVFrame* frame) {
+    TRACE_SCOPE("texture_upload");
     // 根据Frame更新纹理
     if (frame && frame->width > 0 && frame->height > 0) {
         // 视频尺寸变化
@@ -185,7 +189,6 @@ void VideoRenderer::update_textures(AVFrame* frame) {
                      GL_RED, GL_UNSIGNED_BYTE, frame->data[2]);
 
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-        av_frame_free(&frame);
     }
 }
 
@@ -304,6 +307,7 @@ void VideoRenderer::onDrawFrame(AVFrame* frame) {
     glUniform1i(glGetUniformLocation(program, "u_tex"), 1);
     glUniform1i(glGetUniformLocation(program, "v_tex"), 2);
 
+    TRACE_SCOPE("draw");
     glBindVertexArray(vao);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 }
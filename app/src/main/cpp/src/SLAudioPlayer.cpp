@@ -2,12 +2,19 @@
 // Created by Weichuandong on 2025/3/25.
 //
 
+#define LOG_TAG "SLAudioPlayer"
+
 #include "SLAudioPlayer.h"
+#include "core/Trace.hpp"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
 
-SLAudioPlayer::SLAudioPlayer(std::shared_ptr<SafeQueue<AVFrame *>> frameQueue,
+SLAudioPlayer::SLAudioPlayer(std::shared_ptr<SPSCQueue<AVFrame *>> frameQueue,
+                             std::shared_ptr<FramePool> framePool,
                              std::shared_ptr<MediaSynchronizer> sync) :
-    audioFrameQueue(std::move(frameQueue)),
-    synchronizer(std::move(sync))
+    converter(std::move(frameQueue), std::move(framePool), std::move(sync))
 {
     // 分配音频缓冲区
     audioBuffer = new uint8_t[BUFFER_SIZE];
@@ -17,55 +24,22 @@ SLAudioPlayer::~SLAudioPlayer() {
     release();
 
     // 释放音频缓冲区
-    delete audioBuffer;
+    delete[] audioBuffer;
     audioBuffer = nullptr;
-
-    // 释放重采样资源
-    if (swrContext) {
-        swr_free(&swrContext);
-        swrContext = nullptr;
-    }
-
-    if (resampleBuffer) {
-        av_free(resampleBuffer);
-        resampleBuffer = nullptr;
-    }
 }
 
 bool SLAudioPlayer::prepare(int sampleRate, int channels, AVSampleFormat format) {
     std::lock_guard<std::mutex> lock(mutex);
 
-    // 保存输入音频参数
-    inSampleRate = sampleRate;
-    inChannels = channels;
-    inFormat = format;
-    inChannelLayout = av_get_default_channel_layout(channels);
-
-    LOGI("AudioPlayer: prepare play format : %dHz, %d通道, 格式%s, 通道布局为%ld",
-         inSampleRate, inChannels, av_get_sample_fmt_name(inFormat), inChannelLayout);
+    LOGI("AudioPlayer: prepare play format : %dHz, %d通道, 格式%s",
+         sampleRate, channels, av_get_sample_fmt_name(format));
 
     // 创建重采样上下文
-    swrContext = swr_alloc_set_opts(nullptr,
-                                    outChannelLayout,
-                                    outFormat,
-                                    outSampleRate,
-                                    inChannelLayout,
-                                    inFormat,
-                                    inSampleRate,
-                                    0, nullptr);
-    if (!swrContext) {
+    if (!converter.prepare(sampleRate, channels, format, outSampleRate, outChannels)) {
         LOGE("AudioPlayer: can't create swrContext");
         return false;
     }
 
-    int ret = swr_init(swrContext);
-    if (ret < 0) {
-        char errBuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errBuf, AV_ERROR_MAX_STRING_SIZE);
-        LOGE("AudioPlayer: Failed to init swrContext: %s", errBuf);
-        return false;
-    }
-
     // 创建OpenSL ES引擎
     SLresult result = slCreateEngine(&engineObj, 0, nullptr, 0, nullptr, nullptr);
     if (result != SL_RESULT_SUCCESS) {
@@ -251,7 +225,7 @@ void SLAudioPlayer::release() {
 }
 
 void SLAudioPlayer::setVolume(float vol) {
-    volume = std::max(0.0f, std::min(vol, 1.0f));
+    converter.setVolume(std::max(0.0f, std::min(vol, 1.0f)));
 
     if (volumeItf) {
         SLmillibel mb = vol > 0.01f ?
@@ -269,6 +243,7 @@ void SLAudioPlayer::bufferQueueCallback(SLAndroidSimpleBufferQueueItf bq, void *
 
 void SLAudioPlayer::processBuffer() {
     if (!isRunning) return;
+    TRACE_SCOPE("audio_callback");
 
     // 填充缓冲区
     fillBuffer(audioBuffer, BUFFER_SIZE);
@@ -282,136 +257,30 @@ void SLAudioPlayer::processBuffer() {
     }
 }
 
-void SLAudioPlayer::fillBuffer(uint8_t *buffer, int size) {
-    if (!swrContext || !isRunning) {
-        // 未初始化重采样器或未播放，填充静音
-        memset(buffer, 0, size);
-        return;
-    }
+double SLAudioPlayer::getLatency() {
+    if (!bufferQueue) return 0;
 
-    int bytesFilled = 0;
-
-    // 如果之前重采样的数据可用
-    if (availableSamples > 0 && resampleBuffer) {
-        int bytesAvailable = availableSamples * outChannels * 2; // 16位立体声(通道数 * 2Byte)
-        // 可以拷贝的字节数由缓冲区大小和可用数据量共同决定
-        int bytesToCopy = std::min(size, bytesAvailable);
-
-        memcpy(buffer, resampleBuffer, bytesToCopy);
-        bytesFilled += bytesToCopy;
-
-        // 如果数据还有剩余
-        if (bytesToCopy < bytesAvailable) {
-            // 部分使用，移动剩余数据
-            memmove(resampleBuffer, resampleBuffer + bytesToCopy,
-                    bytesAvailable - bytesToCopy);
-            availableSamples -= bytesToCopy / (outChannels * 2);
-        } else {
-            // 全部使用
-            availableSamples = 0;
-        }
-    }
-
-    // 如果缓冲区没有填满
-    while (bytesFilled < size) {
-        AVFrame* frame = nullptr;
-        if (!audioFrameQueue->pop(frame) || !frame) {
-            // 没有帧可用，用静音填充
-            memset(buffer + bytesFilled, 0, size - bytesFilled);
-            break;
-        }
-
-        // 重采样音频帧
-        int bytesResampled = resampleAudio(frame, buffer + bytesFilled, size - bytesFilled);
-        bytesFilled += bytesResampled;
-
-        // 更新音频时钟
-        if (frame->pts != AV_NOPTS_VALUE) {
-            double pts = frame->pts * av_q2d(AudioTimeBase);
-
-            // 记录当前时间点
-            audioClock.pts = pts;
-            audioClock.lastUpdateTime = av_gettime() / 1000000.0;
-            // 上传到主时钟
-            synchronizer->update(audioClock, MediaSynchronizer::SyncSource::AUDIO);
-        }
-
-        av_frame_free(&frame);
+    // 队列中每个缓冲区都是完整的BUFFER_SIZE字节
+    SLAndroidSimpleBufferQueueState state;
+    if ((*bufferQueue)->GetState(bufferQueue, &state) != SL_RESULT_SUCCESS) {
+        return 0;
     }
-
-    // 应用音量
-    applyVolume((int16_t*)buffer, size / 2);
+    return (double)state.count * BUFFER_SIZE / (outChannels * 2) / outSampleRate;
 }
 
-int SLAudioPlayer::resampleAudio(AVFrame *frame, uint8_t *outBuffer, int outSize) {
-    if (!swrContext || !frame || !frame->extended_data) return 0;
-
-    // 计算输出样本数
-    int outSamples = av_rescale_rnd(
-            swr_get_delay(swrContext, frame->sample_rate) + frame->nb_samples,
-            outSampleRate, frame->sample_rate, AV_ROUND_UP);
-
-    // 计算输出数据大小
-    int outBytes = outSamples * outChannels * 2; // 16位立体声
-
-    // 当前帧获取的数据量超出outBuffer的接受量
-    if (outBytes > outSize) {
-        // 确保重采样缓冲区足够大
-        if (outBytes > resampleBufferSize) {
-            resampleBuffer = (uint8_t*)av_realloc(resampleBuffer, outBytes);
-            resampleBufferSize = outBytes;
-        }
-
-        // 指向中间缓冲区
-        uint8_t* outPtr = resampleBuffer;
-
-        // 执行重采样
-        int samplesConverted = swr_convert(
-                swrContext,
-                &outPtr, outSamples,
-                (const uint8_t**)frame->extended_data, frame->nb_samples);
-
-        if (samplesConverted <= 0) return 0;
-
-        // 计算转换后的字节数
-        int bytesConverted = samplesConverted * outChannels * 2;
-
-        // 复制能放入输出缓冲区的部分
-        int bytesToCopy = std::min(bytesConverted, outSize);
-        memcpy(outBuffer, resampleBuffer, bytesToCopy);
-
-        // 保存剩余的样本
-        if (bytesToCopy < bytesConverted) {
-            memmove(resampleBuffer, resampleBuffer + bytesToCopy,
-                    bytesConverted - bytesToCopy);
-            availableSamples = (bytesConverted - bytesToCopy) / (outChannels * 2);
-        }
-
-        return bytesToCopy;
-    } else {
-        // 直接重采样到输出缓冲区
-        uint8_t* outPtr = outBuffer;
-
-        int samplesConverted = swr_convert(
-                swrContext,
-                &outPtr, outSamples,
-                (const uint8_t**)frame->extended_data, frame->nb_samples);
-
-        if (samplesConverted <= 0) return 0;
-
-        return samplesConverted * outChannels * 2;
+void SLAudioPlayer::fillBuffer(uint8_t *buffer, int size) {
+    int bytesFilled = 0;
+    if (converter.isPrepared() && isRunning) {
+        // 回调时正在填充的缓冲区还没有入队，排在它前面的是队列中剩余的缓冲区
+        bytesFilled = converter.fill(buffer, size, getLatency());
     }
-}
-
-void SLAudioPlayer::applyVolume(int16_t *buffer, int numSamples) {
-    float vol = volume.load();
-    if (vol >= 0.999f) return; // 音量接近1.0，不需要处理
 
-    for (int i = 0; i < numSamples; i++) {
-        buffer[i] = (int16_t)(buffer[i] * vol);
+    // 未初始化重采样器、未播放或没有帧可用，剩余部分用静音填充
+    if (bytesFilled < size) {
+        memset(buffer + bytesFilled, 0, size - bytesFilled);
     }
 }
 
 void SLAudioPlayer::setTimeBase(const AVRational &timeBase) {
-    AudioTimeBase = timeBase;
+    converter.setTimeBase(timeBase);
 }
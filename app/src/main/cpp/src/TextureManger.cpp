@@ -2,6 +2,8 @@
 // Created by Weichuandong on 2025/3/13.
 //
 
+#define LOG_TAG "TextureManager"
+
 #include "TextureManger.h"
 
 TextureManager::TextureManager() {
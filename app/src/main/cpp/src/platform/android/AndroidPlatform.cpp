@@ -0,0 +1,194 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#define LOG_TAG "AndroidPlatform"
+
+#include "platform/Platform.h"
+#include "SLAudioPlayer.h"
+#include "Decoder/MediaCodecVideoDecoder.h"
+
+#include <vector>
+
+// 从AVCC格式的extradata中取出第一个SPS和PPS，转换为带起始码的Annex-B格式
+static bool extractSPSPPS(AVCodecParameters *codecParams, std::vector<uint8_t> &sps,
+                          std::vector<uint8_t> &pps) {
+    if (!codecParams || !codecParams->extradata || codecParams->extradata_size < 7) {
+        LOGE("Invalid extradata");
+        return false;
+    }
+
+    const uint8_t* extradata = codecParams->extradata;
+    int extradata_size = codecParams->extradata_size;
+    std::vector<uint8_t> startCode = {0x00, 0x00, 0x00, 0x01};
+
+    // 检查是否为AVCC格式（一般mp4容器采用）
+    if (extradata[0] == 1) { // AVCC格式以1开头
+        int offset = 5;      // 跳过版本、profile、compatibility、level和长度字段
+
+        // SPS组和PPS组各一个
+        for (int group = 0; group < 2 && offset < extradata_size; ++group) {
+            // 获取SPS或者PPS个数,第六个字节[111......]前三个bit默认为111，后五个bit表示接下来的SPS或者PPS个数
+            int num = extradata[offset] & 0x1F;
+            offset++;
+
+            for (int i = 0; i < num && offset + 2 <= extradata_size; ++i) {
+                // 读取当前SPS或者PPS长度, 2字节大端序
+                int length = (extradata[offset] << 8) | extradata[offset + 1];
+                offset += 2;
+                if (length <= 0 || offset + length > extradata_size) {
+                    LOGE("Invalid SPS/PPS length: %d", length);
+                    return false;
+                }
+                // 获取类型
+                int type = extradata[offset] & 0x1F;
+
+                // 目前只保留第一个SPS或PPS
+                std::vector<uint8_t>* target = type == 7 ? &sps : (type == 8 ? &pps : nullptr);
+                if (target && target->empty()) {
+                    target->reserve(4 + length);
+                    target->assign(startCode.begin(), startCode.end());
+                    target->insert(target->end(), extradata + offset, extradata + offset + length);
+                }
+                offset += length;
+            }
+        }
+        return !sps.empty() && !pps.empty();
+    }
+
+    // Annex-B格式的extradata(开头是起始码0x00000001)暂不支持
+    return false;
+}
+
+// 从hvcC格式的extradata中取出所有VPS/SPS/PPS，按顺序转换为带起始码的Annex-B格式，作为MediaCodec的csd-0
+static bool extractHEVCParameterSets(AVCodecParameters *codecParams, std::vector<uint8_t> &csd) {
+    if (!codecParams || !codecParams->extradata || codecParams->extradata_size < 23) {
+        LOGE("Invalid hvcC extradata");
+        return false;
+    }
+
+    const uint8_t* extradata = codecParams->extradata;
+    int extradata_size = codecParams->extradata_size;
+    const uint8_t startCode[] = {0x00, 0x00, 0x00, 0x01};
+
+    // extradata本身已经是Annex-B格式
+    if (extradata[0] == 0 && extradata[1] == 0 && (extradata[2] == 1 || (extradata[2] == 0 && extradata[3] == 1))) {
+        csd.assign(extradata, extradata + extradata_size);
+        return true;
+    }
+
+    // hvcC: 22字节的配置信息之后是numOfArrays，每个array为1字节NAL类型、2字节NAL个数，
+    // 每个NAL为2字节大端长度加数据
+    int offset = 22;
+    int numArrays = extradata[offset++];
+    for (int i = 0; i < numArrays && offset + 3 <= extradata_size; ++i) {
+        int type = extradata[offset] & 0x3F;
+        int num = (extradata[offset + 1] << 8) | extradata[offset + 2];
+        offset += 3;
+        for (int j = 0; j < num && offset + 2 <= extradata_size; ++j) {
+            int length = (extradata[offset] << 8) | extradata[offset + 1];
+            offset += 2;
+            if (length <= 0 || offset + length > extradata_size) {
+                LOGE("Invalid hvcC NAL length: %d", length);
+                return false;
+            }
+            // 32~34: VPS/SPS/PPS
+            if (type >= 32 && type <= 34) {
+                csd.insert(csd.end(), startCode, startCode + 4);
+                csd.insert(csd.end(), extradata + offset, extradata + offset + length);
+            }
+            offset += length;
+        }
+    }
+    return !csd.empty();
+}
+
+std::unique_ptr<IAudioSink> createAudioSink(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                                            std::shared_ptr<FramePool> framePool,
+                                            std::shared_ptr<MediaSynchronizer> sync) {
+    return std::make_unique<SLAudioPlayer>(std::move(frameQueue), std::move(framePool), std::move(sync));
+}
+
+std::vector<DecoderFactory::Caps> getHardwareVideoDecoderCaps() {
+    // NDK没有查询MediaCodecList的接口，这里是几乎所有设备都支持的保守范围，超出时直接软解。
+    // 输出只支持8bit YUV420，10bit的profile不使用硬解
+    std::vector<DecoderFactory::Caps> capsList(4);
+    capsList[0].codecId = AV_CODEC_ID_H264;
+    capsList[0].profiles = {FF_PROFILE_H264_BASELINE, FF_PROFILE_H264_CONSTRAINED_BASELINE,
+                            FF_PROFILE_H264_MAIN, FF_PROFILE_H264_HIGH};
+    capsList[0].maxLevel = 51;      // level_idc, 5.1
+    capsList[1].codecId = AV_CODEC_ID_HEVC;
+    capsList[1].profiles = {FF_PROFILE_HEVC_MAIN};
+    capsList[1].maxLevel = 153;     // general_level_idc = 30 * 5.1
+    capsList[2].codecId = AV_CODEC_ID_VP9;
+    capsList[2].profiles = {FF_PROFILE_VP9_0};
+    capsList[3].codecId = AV_CODEC_ID_AV1;
+    capsList[3].profiles = {FF_PROFILE_AV1_MAIN};
+    for (auto& caps : capsList) {
+        caps.maxWidth = 3840;
+        caps.maxHeight = 2160;
+        caps.maxBitDepth = 8;
+    }
+    return capsList;
+}
+
+std::unique_ptr<IVideoDecoder> createHardwareVideoDecoder(AVCodecParameters* codecParameters,
+                                                          bool& needAnnexB) {
+    needAnnexB = false;
+    if (!codecParameters) return nullptr;
+
+    auto config = DecoderConfig();
+    config.format = config.fromAVFormat(static_cast<AVPixelFormat>(codecParameters->format));
+    config.width = codecParameters->width;
+    config.height = codecParameters->height;
+    config.param = codecParameters;
+
+    bool annexB = false;
+    switch (codecParameters->codec_id) {
+        case AV_CODEC_ID_H264: {
+            std::vector<uint8_t> sps, pps;
+            if (!extractSPSPPS(codecParameters, sps, pps)) {
+                LOGE("failed to extract sps/pps, MediaCodec not used");
+                return nullptr;
+            }
+            config.type = "video/avc";
+            config.extraData.emplace("csd-0", sps);
+            config.extraData.emplace("csd-1", pps);
+            annexB = true;
+            break;
+        }
+        case AV_CODEC_ID_HEVC: {
+            std::vector<uint8_t> csd;
+            if (!extractHEVCParameterSets(codecParameters, csd)) {
+                LOGE("failed to extract vps/sps/pps, MediaCodec not used");
+                return nullptr;
+            }
+            config.type = "video/hevc";
+            config.extraData.emplace("csd-0", csd);
+            annexB = true;
+            break;
+        }
+        case AV_CODEC_ID_VP9:
+            config.type = "video/x-vnd.on2.vp9";
+            break;
+        case AV_CODEC_ID_AV1:
+            config.type = "video/av01";
+            if (codecParameters->extradata && codecParameters->extradata_size > 0) {
+                config.extraData.emplace("csd-0", std::vector<uint8_t>(
+                        codecParameters->extradata, codecParameters->extradata + codecParameters->extradata_size));
+            }
+            break;
+        default:
+            LOGI("MediaCodec not used for codec %s", avcodec_get_name(codecParameters->codec_id));
+            return nullptr;
+    }
+
+    auto decoder = std::make_unique<MediaCodecVideoDecoder>();
+    if (!decoder->configure(config)) {
+        LOGE("failed to configure MediaCodecVideoDecoder(%s)", config.type.c_str());
+        return nullptr;
+    }
+
+    needAnnexB = annexB;
+    return decoder;
+}
@@ -0,0 +1,210 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#define LOG_TAG "DesktopAudioSink"
+
+#include "platform/desktop/DesktopAudioSink.h"
+#include "core/Trace.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+DesktopAudioSink::DesktopAudioSink(std::shared_ptr<SPSCQueue<AVFrame *>> frameQueue,
+                                   std::shared_ptr<FramePool> framePool,
+                                   std::shared_ptr<MediaSynchronizer> sync,
+                                   bool realtime) :
+    converter(std::move(frameQueue), std::move(framePool), std::move(sync)),
+    audioBuffer(BUFFER_SIZE),
+    realtime(realtime)
+{
+
+}
+
+DesktopAudioSink::~DesktopAudioSink() {
+    release();
+}
+
+bool DesktopAudioSink::prepare(int sampleRate, int channels, AVSampleFormat format) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    LOGI("prepare play format : %dHz, %d通道, 格式%s",
+         sampleRate, channels, av_get_sample_fmt_name(format));
+
+    if (!converter.prepare(sampleRate, channels, format, OUT_SAMPLE_RATE, OUT_CHANNELS)) {
+        LOGE("can't create swrContext");
+        return false;
+    }
+
+    if (!onOpen()) {
+        LOGE("failed to open output");
+        converter.release();
+        return false;
+    }
+
+    isReady = true;
+    return true;
+}
+
+void DesktopAudioSink::start() {
+    if (!isReady) {
+        LOGE("not ready, can't play");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    isRunning = true;
+    if (!playThread.joinable()) {
+        exitRequested = false;
+        playThread = std::thread(&DesktopAudioSink::playThreadFunc, this);
+    }
+    runCond.notify_all();
+}
+
+void DesktopAudioSink::pause() {
+    isRunning = false;
+}
+
+void DesktopAudioSink::resume() {
+    std::lock_guard<std::mutex> lock(mutex);
+    isRunning = true;
+    runCond.notify_all();
+}
+
+void DesktopAudioSink::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isRunning = false;
+        exitRequested = true;
+        runCond.notify_all();
+    }
+    if (playThread.joinable()) {
+        playThread.join();
+    }
+}
+
+void DesktopAudioSink::release() {
+    stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isReady) {
+        onClose();
+        converter.release();
+        isReady = false;
+    }
+}
+
+double DesktopAudioSink::getLatency() {
+    // 非realtime时数据写出即视为播放完
+    if (!realtime) return 0;
+    int64_t remaining = playoutEndTime.load(std::memory_order_relaxed) - av_gettime_relative();
+    return remaining > 0 ? remaining / 1000000.0 : 0;
+}
+
+void DesktopAudioSink::playThreadFunc() {
+    TRACE_THREAD_NAME("audio_out");
+    using Clock = std::chrono::steady_clock;
+    const int bytesPerFrame = converter.getBytesPerFrame();
+    Clock::time_point deadline = Clock::now();
+
+    while (!exitRequested) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!isRunning && !exitRequested) {
+                runCond.wait(lock, [this]() { return isRunning || exitRequested; });
+                // 暂停期间不补数据，从恢复时刻重新计时
+                deadline = Clock::now();
+            }
+        }
+        if (exitRequested) break;
+
+        int size = (int)audioBuffer.size();
+        int bytesFilled = 0;
+        {
+            TRACE_SCOPE("audio_callback");
+            bytesFilled = converter.fill(audioBuffer.data(), size, getLatency(), POP_TIMEOUT_MS);
+        }
+
+        if (realtime) {
+            // 与真实设备一样，没有数据时输出静音
+            memset(audioBuffer.data() + bytesFilled, 0, size - bytesFilled);
+            bytesFilled = size;
+        } else if (bytesFilled == 0) {
+            // 队列暂停或流结束时pop会立即返回，避免空转
+            std::this_thread::sleep_for(std::chrono::milliseconds(POP_TIMEOUT_MS));
+            continue;
+        }
+
+        write(audioBuffer.data(), bytesFilled);
+        writtenBytes.fetch_add(bytesFilled, std::memory_order_relaxed);
+
+        if (realtime) {
+            deadline += std::chrono::microseconds(
+                    (int64_t)bytesFilled / bytesPerFrame * 1000000 / converter.getOutSampleRate());
+            auto now = Clock::now();
+            // 这次的数据在deadline时"播放"完
+            playoutEndTime.store(av_gettime_relative() + std::chrono::duration_cast<std::chrono::microseconds>(
+                    deadline - now).count(), std::memory_order_relaxed);
+            if (deadline > now) {
+                std::this_thread::sleep_until(deadline);
+            } else if (now - deadline > std::chrono::milliseconds(100)) {
+                // 落后太多(调度或调试中断)时不追赶
+                deadline = now;
+            }
+        }
+    }
+}
+
+bool FileAudioSink::onOpen() {
+    file = fopen(filePath.c_str(), "wb");
+    if (!file) {
+        LOGE("failed to open %s", filePath.c_str());
+        return false;
+    }
+    dataBytes = 0;
+    // 先写入占位的文件头，关闭时回填数据长度
+    writeHeader();
+    return true;
+}
+
+void FileAudioSink::write(const uint8_t *data, int size) {
+    if (!file) return;
+    dataBytes += (uint32_t)fwrite(data, 1, size, file);
+}
+
+void FileAudioSink::onClose() {
+    if (!file) return;
+    fseek(file, 0, SEEK_SET);
+    writeHeader();
+    fclose(file);
+    file = nullptr;
+    LOGI("wrote %u bytes to %s", dataBytes, filePath.c_str());
+}
+
+void FileAudioSink::writeHeader() {
+    auto putU32 = [this](uint32_t v) {
+        uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+        fwrite(b, 1, 4, file);
+    };
+    auto putU16 = [this](uint16_t v) {
+        uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+        fwrite(b, 1, 2, file);
+    };
+
+    const uint16_t bitsPerSample = 16;
+    const uint16_t blockAlign = OUT_CHANNELS * bitsPerSample / 8;
+
+    fwrite("RIFF", 1, 4, file);
+    putU32(36 + dataBytes);
+    fwrite("WAVEfmt ", 1, 8, file);
+    putU32(16);                                 // fmt块长度
+    putU16(1);                                  // PCM
+    putU16(OUT_CHANNELS);
+    putU32(OUT_SAMPLE_RATE);
+    putU32(OUT_SAMPLE_RATE * blockAlign);       // 字节率
+    putU16(blockAlign);
+    putU16(bitsPerSample);
+    fwrite("data", 1, 4, file);
+    putU32(dataBytes);
+}
@@ -0,0 +1,30 @@
+//
+// Created by Weichuandong on 2025/4/20.
+//
+
+#include "platform/Platform.h"
+#include "platform/desktop/DesktopAudioSink.h"
+
+#include <cstdlib>
+
+std::unique_ptr<IAudioSink> createAudioSink(std::shared_ptr<SPSCQueue<AVFrame*>> frameQueue,
+                                            std::shared_ptr<FramePool> framePool,
+                                            std::shared_ptr<MediaSynchronizer> sync) {
+    const char* path = getenv("GLMEDIAKIT_AUDIO_FILE");
+    if (path && path[0]) {
+        return std::make_unique<FileAudioSink>(std::move(frameQueue), std::move(framePool),
+                                               std::move(sync), path);
+    }
+    return std::make_unique<NullAudioSink>(std::move(frameQueue), std::move(framePool), std::move(sync));
+}
+
+std::vector<DecoderFactory::Caps> getHardwareVideoDecoderCaps() {
+    return {};
+}
+
+std::unique_ptr<IVideoDecoder> createHardwareVideoDecoder(AVCodecParameters* /*codecParameters*/,
+                                                          bool& needAnnexB) {
+    // 桌面环境只使用FFmpeg软解
+    needAnnexB = false;
+    return nullptr;
+}
@@ -0,0 +1,58 @@
+package com.example.glmediakit;
+
+import java.util.Arrays;
+
+/**
+ * 帧节奏报告，由native层Player::getPacingReport()填充，切换文件时清零。
+ * 以显示刷新周期为单位比较相邻两帧的实际显示间隔与按pts应有的间隔，时间单位为毫秒
+ */
+public class FramePacingReport {
+
+    public final double refreshIntervalMs;
+    public final long framesPresented;
+    // 交换缓冲区比预期显示时间晚超过一个刷新周期的帧数
+    public final long lateFrames;
+    // 显示间隔与应有间隔不一致的帧数
+    public final long jankFrames;
+    // 上一帧被多显示的刷新周期数
+    public final long repeatedFrames;
+    // 内容没有被显示出来的刷新周期数
+    public final long skippedFrames;
+    // 下标为相邻两帧的显示间隔(刷新周期数)，最后一项包含5个及以上
+    public final long[] intervalHistogram;
+    // 交换缓冲区完成 - 预期显示时间
+    public final PlaybackStats.Percentiles lateness;
+    // 开始绘制到交换缓冲区完成
+    public final PlaybackStats.Percentiles swapTime;
+
+    // 下标与JNIPlayer.cpp中nativeGetPacingReport的填充顺序一致
+    FramePacingReport(double[] values) {
+        refreshIntervalMs = values[0];
+        framesPresented = (long) values[1];
+        lateFrames = (long) values[2];
+        jankFrames = (long) values[3];
+        repeatedFrames = (long) values[4];
+        skippedFrames = (long) values[5];
+        intervalHistogram = new long[6];
+        for (int i = 0; i < intervalHistogram.length; i++) {
+            intervalHistogram[i] = (long) values[6 + i];
+        }
+        lateness = new PlaybackStats.Percentiles(values, 12);
+        swapTime = new PlaybackStats.Percentiles(values, 16);
+    }
+
+    @Override
+    public String toString() {
+        return "FramePacingReport{" +
+                "refresh=" + String.format("%.2fms", refreshIntervalMs) +
+                ", presented=" + framesPresented +
+                ", late=" + lateFrames +
+                ", jank=" + jankFrames +
+                ", repeated=" + repeatedFrames +
+                ", skipped=" + skippedFrames +
+                ", intervals=" + Arrays.toString(intervalHistogram) +
+                ", lateness{" + lateness + "}" +
+                ", swap{" + swapTime + "}" +
+                '}';
+    }
+}
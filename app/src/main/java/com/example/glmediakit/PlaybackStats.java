@@ -0,0 +1,94 @@
+package com.example.glmediakit;
+
+/**
+ * 播放运行时统计快照，由native层Player::getStats()填充，切换文件时清零。
+ * 耗时与偏差单位为毫秒，分位数由直方图统计，误差约6%
+ */
+public class PlaybackStats {
+
+    public static class Percentiles {
+        public final double p50Ms;
+        public final double p90Ms;
+        public final double p99Ms;
+        public final double maxMs;
+
+        Percentiles(double[] values, int offset) {
+            p50Ms = values[offset];
+            p90Ms = values[offset + 1];
+            p99Ms = values[offset + 2];
+            maxMs = values[offset + 3];
+        }
+
+        @Override
+        public String toString() {
+            return String.format("p50=%.2f p90=%.2f p99=%.2f max=%.2f", p50Ms, p90Ms, p99Ms, maxMs);
+        }
+    }
+
+    // 队列深度
+    public final int videoPacketQueuePackets;
+    public final long videoPacketQueueBytes;
+    public final int audioPacketQueuePackets;
+    public final long audioPacketQueueBytes;
+    public final int videoFrameQueueSize;
+    public final int audioFrameQueueSize;
+
+    // 累计计数
+    public final long videoFramesDecoded;
+    public final long audioFramesDecoded;
+    public final long videoFramesRendered;
+    // seek之前的旧帧
+    public final long videoFramesDropped;
+    // 落后太多、上传纹理之前丢弃的帧
+    public final long videoFramesDroppedLate;
+    public final long bytesRead;
+
+    // 最近一帧视频pts - 主时钟，正值表示视频超前
+    public final double lastAvDriftMs;
+    // 音视频偏差的绝对值
+    public final Percentiles avDrift;
+    // 视频每个packet的解码耗时
+    public final Percentiles videoDecodeTime;
+    // 每帧纹理上传和绘制提交的耗时
+    public final Percentiles uploadTime;
+    // 视频落后时的解码级别: 0正常，1跳过非参考帧，2只解码关键帧
+    public final int videoDecodeLevel;
+
+    // 下标与JNIPlayer.cpp中nativeGetStats的填充顺序一致
+    PlaybackStats(double[] values) {
+        videoPacketQueuePackets = (int) values[0];
+        videoPacketQueueBytes = (long) values[1];
+        audioPacketQueuePackets = (int) values[2];
+        audioPacketQueueBytes = (long) values[3];
+        videoFrameQueueSize = (int) values[4];
+        audioFrameQueueSize = (int) values[5];
+        videoFramesDecoded = (long) values[6];
+        audioFramesDecoded = (long) values[7];
+        videoFramesRendered = (long) values[8];
+        videoFramesDropped = (long) values[9];
+        bytesRead = (long) values[10];
+        lastAvDriftMs = values[11];
+        avDrift = new Percentiles(values, 12);
+        videoDecodeTime = new Percentiles(values, 16);
+        uploadTime = new Percentiles(values, 20);
+        videoFramesDroppedLate = (long) values[24];
+        videoDecodeLevel = (int) values[25];
+    }
+
+    @Override
+    public String toString() {
+        return "PlaybackStats{" +
+                "packetQueue(v/a)=" + videoPacketQueuePackets + "/" + audioPacketQueuePackets +
+                ", frameQueue(v/a)=" + videoFrameQueueSize + "/" + audioFrameQueueSize +
+                ", decoded(v/a)=" + videoFramesDecoded + "/" + audioFramesDecoded +
+                ", rendered=" + videoFramesRendered +
+                ", dropped=" + videoFramesDropped +
+                ", droppedLate=" + videoFramesDroppedLate +
+                ", decodeLevel=" + videoDecodeLevel +
+                ", bytesRead=" + bytesRead +
+                ", avDrift{" + avDrift + "}" +
+                ", decode{" + videoDecodeTime + "}" +
+                ", upload{" + uploadTime + "}" +
+                '}';
+    }
+}
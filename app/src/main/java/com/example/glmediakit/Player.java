@@ -34,6 +34,30 @@ public class Player implements SurfaceListener {
 
     private native void nativeStop(long handle);
 
+    private native void nativeSeekTo(long handle, double position, boolean accurate);
+
+    private native double nativeGetLastSeekLatencyMs(long handle);
+
+    private native String nativeGetVideoDecoderInfo(long handle);
+
+    private native boolean nativeSetPlaybackRate(long handle, float rate);
+
+    private native double[] nativeGetStats(long handle);
+
+    private native double[] nativeGetPacingReport(long handle);
+
+    private native void nativeSetDisplayRefreshRate(long handle, float hz);
+
+    private native boolean nativeStartTrace(long handle);
+
+    private native boolean nativeStopTrace(long handle, String path);
+
+    private native void nativeBeginScrub(long handle);
+
+    private native void nativeScrubTo(long handle, double position);
+
+    private native void nativeEndScrub(long handle);
+
     private native void nativeRelease(long handle);
 
     private native void nativeSurfaceCreate(long handle, Surface surface);
@@ -82,6 +106,158 @@ public class Player implements SurfaceListener {
         nativeStop(nativeHandle);
     }
 
+    /**
+     * 精确跳转到指定位置
+     * @param position 目标位置(秒)
+     */
+    public void seekTo(double position) {
+        seekTo(position, true);
+    }
+
+    /**
+     * 跳转到指定位置
+     * @param position 目标位置(秒)
+     * @param accurate true: 解码到目标帧; false: 停在目标位置之前最近的关键帧，速度更快
+     */
+    public void seekTo(double position, boolean accurate) {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return;
+        }
+        nativeSeekTo(nativeHandle, position, accurate);
+    }
+
+    /**
+     * 开始拖动进度条(如SeekBar的onStartTrackingTouch)，拖动期间只解码关键帧
+     */
+    public void beginScrub() {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return;
+        }
+        nativeBeginScrub(nativeHandle);
+    }
+
+    /**
+     * 拖动中的位置更新，可以高频调用，只有最新的位置会被处理
+     * @param position 目标位置(秒)
+     */
+    public void scrubTo(double position) {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return;
+        }
+        nativeScrubTo(nativeHandle, position);
+    }
+
+    /**
+     * 结束拖动，从最后的位置恢复正常播放(或保持暂停)
+     */
+    public void endScrub() {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return;
+        }
+        nativeEndScrub(nativeHandle);
+    }
+
+    /**
+     * 设置播放速度，音频变速不变调
+     * @param rate 0.25~4.0
+     * @return 超出范围时返回false
+     */
+    public boolean setPlaybackRate(float rate) {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return false;
+        }
+        return nativeSetPlaybackRate(nativeHandle, rate);
+    }
+
+    /**
+     * @return 最近一次seek从请求到第一帧解码完成的耗时(毫秒)
+     */
+    public double getLastSeekLatencyMs() {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return 0;
+        }
+        return nativeGetLastSeekLatencyMs(nativeHandle);
+    }
+
+    /**
+     * @return 视频解码器的选择结果(硬解/软解)及原因，例如"hardware(profile 110 not supported) -> FFmpeg(ok)"
+     */
+    public String getVideoDecoderInfo() {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return null;
+        }
+        return nativeGetVideoDecoderInfo(nativeHandle);
+    }
+
+    /**
+     * 获取运行时统计快照，可以频繁调用
+     * @return 未初始化时返回null
+     */
+    public PlaybackStats getStats() {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return null;
+        }
+        double[] values = nativeGetStats(nativeHandle);
+        return values != null ? new PlaybackStats(values) : null;
+    }
+
+    /**
+     * 获取帧节奏报告(迟到、重复、跳过的帧以及显示间隔分布)，比平均帧率更能反映卡顿
+     * @return 未初始化时返回null
+     */
+    public FramePacingReport getPacingReport() {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return null;
+        }
+        double[] values = nativeGetPacingReport(nativeHandle);
+        return values != null ? new FramePacingReport(values) : null;
+    }
+
+    /**
+     * 设置显示刷新率，帧节奏分析以刷新周期为单位，默认60Hz
+     * @param hz 如Display.getRefreshRate()
+     */
+    public void setDisplayRefreshRate(float hz) {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return;
+        }
+        nativeSetDisplayRefreshRate(nativeHandle, hz);
+    }
+
+    /**
+     * 开始记录事件追踪，native库需要以-DGLMEDIAKIT_TRACE=ON编译
+     * @return 追踪未编译进native库时返回false
+     */
+    public boolean startTrace() {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return false;
+        }
+        return nativeStartTrace(nativeHandle);
+    }
+
+    /**
+     * 停止追踪并导出为Chrome trace JSON，可以用chrome://tracing或ui.perfetto.dev打开
+     * @param path 输出文件路径
+     */
+    public boolean stopTrace(String path) {
+        if (nativeHandle == 0) {
+            Log.e(TAG, "Player don't initialized");
+            return false;
+        }
+        return nativeStopTrace(nativeHandle, path);
+    }
+
     public void release() {
         Log.i(TAG, "Player release");
         if (nativeHandle == 0) {
@@ -140,6 +140,24 @@ public class MediaCodecDecoder {
         return true;
     }
 
+    /**
+     * 清空解码器中的数据，用于seek。同步模式下flush后可以直接继续送入数据
+     * @return 是否成功
+     * */
+    public boolean flush() {
+        if (decoder == null) {
+            return false;
+        }
+        try {
+            decoder.flush();
+            state = decoderStates.Flushed;
+            return true;
+        } catch (IllegalStateException e) {
+            Log.e(tag, "Decoder flush in illegal state", e);
+        }
+        return false;
+    }
+
     public long getPts() {
         return bufferInfo.presentationTimeUs;
     }